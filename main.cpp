@@ -8,6 +8,40 @@
 #include <cstdlib>
 #include <time.h>
 #include <cmath>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <csignal>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+#include <memory>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ROXY_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+#endif
 
 /*
  *     ____  ____ _  __     
@@ -31,34 +65,337 @@
  */
 
 
+// Trapdoor
+// RSA trapdoor primes along with the modulus and private exponent derived from them, so that repeated
+// inversions skip the extended Euclidean algorithm.
+struct Trapdoor {
+    uint32_t p;
+    uint32_t q;
+    uint32_t n;
+    uint32_t d;
+};
+
+// Asymmetric ciphertext header
+// Ciphertexts open with one element-sized header: the magic "ROXY", a format version, a flags byte, and two
+// bytes that are zero unless ASYMM_FLAG_RECIPIENT is set, when they identify the recipient key (recipientKeyId()).
+// Ciphertexts without it predate the header and are decoded as bare element streams.
+const char asymmMagic[] = "ROXY";
+const uint8_t asymmVersion = 1;
+const uint32_t asymmHeaderLen = 8;
+const uint8_t ASYMM_FLAG_COMPRESSED = 0x01; // cleartext was passed through lzCompress before encoding
+const uint8_t ASYMM_FLAG_HYBRID = 0x02; // only a session key is encoded; the cleartext follows, XORed with its key stream
+const uint8_t ASYMM_FLAG_RECIPIENT = 0x04; // encoded for a recipient key pair from --keygen rather than the built-in trapdoor
+const uint32_t hybridKeyLen = 32; // session key bytes, encoded as hybridKeyLen * 8 elements
+
+// Recipients
+// A recipient's public key is the modulus n alone (e is fixed at 17); the private key is p and q.
+struct Recipient {
+    std::string name;
+    uint32_t n;
+};
+
 // forward declarations
 void encrypt(); // launches encryption handler
 void decrypt(); // launches decryption handler
 void symmEncrypt(); // encrypts with symmetric encryption via XOR
 void asymmEncrypt(); // encrypts with asymmetric encryption via translucent sets
+void asymmEncryptBatch(); // encrypts one cleartext for a list of recipient public keys in a single pass
 void symmDecrypt(); // decrypts with symmetric encryption via XOR
 void asymmDecrypt(); // decrypts with asymmetric encryption via translucent sets
 uint32_t customHash(uint32_t num); // used for efficient 32-bit uint seed generation
 uint32_t invertRSA(uint32_t prev, uint32_t p, uint32_t q); // inverts the current value of x0 via trapdoor permutation
+uint32_t invertRSA(uint32_t prev, const Trapdoor& td); // inverts x0 with a precomputed private exponent
+Trapdoor makeTrapdoor(uint32_t p, uint32_t q); // derives the modulus and private exponent for p,q once
 uint32_t rsa(uint32_t p, uint32_t q, uint32_t seed); // RSA for round encoding
+uint32_t rsa(uint32_t n, uint32_t seed); // RSA for round encoding given only the public modulus
 std::string iterativeHash(std::string key, uint32_t tarlen); // pads a seed to tarlen bytes
 std::string strXOR(std::string x, std::string y); // bitwise XOR of two n-len bitstrings
 std::string strToBin(std::string str); // convert a string to binary representation
 std::string binToStr(std::string str); // convert a bitstring to characters
 std::string constructTranslucentElement(); // constructs element of translucent set for asymmetric system
+uint64_t translucentElement(uint32_t n, uint32_t seed); // constructs a packed element of the translucent set for modulus n from seed
+std::vector<uint32_t> fillEntropyPool(size_t count); // draws count words of element entropy to share between recipients
+std::string asymmEncodeBits(const std::string& bitstr, uint32_t n, const std::vector<uint32_t>& pool, uint32_t salt); // encodes a bitstring for modulus n from a shared entropy pool, two words per bit
+bool elementsBelowModulus(const std::string& elements, uint32_t n); // checks that no element's high half gives away a 0 bit
 std::string randomAsymmElement(); // returns a pseudorandom non-translucent 64 bit number as a bitstring
 std::vector<uint32_t> blumblumshub(uint32_t p1, uint32_t p2, uint32_t seed, uint32_t iterations); // CPRNG
 bool isPrime(uint32_t num); // primality tester
 bool hcpredicate(uint32_t number); // hardcore predicate for RSA enciphering, defined as a sum over GF2 of all elements.
 bool isTranslucentElement(std::string bitstr, uint32_t p, uint32_t q); // determines if a 64 bit bitstring is an element of St, returning 1 if it is, and 0 otherwise.
+bool isTranslucentElement(std::string bitstr, const Trapdoor& td); // membership test against a precomputed trapdoor
+std::string fitSymmKey(std::string key, uint32_t tarlen); // truncates or pads a symmetric key to tarlen bytes
+std::string symmXOR(std::string text, std::string key); // XORs raw text with an equal length raw key
+std::string asymmEncode(std::string cleartext); // encodes raw cleartext as a stream of 64 bit elements
+std::string asymmDecode(std::string ciphertext, const Trapdoor& td); // decodes a stream of 64 bit elements to raw cleartext
+std::string asymmSeal(std::string cleartext, uint8_t flags); // prepends the asymmetric header to the encoded cleartext, compressed or hybrid per flags
+uint8_t asymmPrepare(std::string& cleartext, uint8_t flags, std::string& bulk); // applies the compression and hybrid stages ahead of encoding
+std::string asymmEncodeKey(std::string sessionKey); // encodes a hybrid session key with fresh entropy for every element
+bool asymmOpen(std::string ciphertext, const Trapdoor& td, std::string& cleartext); // reads the asymmetric header, decodes, and reverses any flagged stages
+bool asymmStripHeader(std::string& ciphertext, uint8_t& flags, uint16_t& keyId); // removes and parses the asymmetric header, if present
+std::string expandSessionKey(std::string sessionKey, uint32_t len); // expands a hybrid session key to a len byte key stream
+std::string asymmHeader(uint8_t flags, uint16_t keyId); // builds the asymmetric header for the given flags and recipient key
+uint16_t recipientKeyId(uint32_t n); // 16 bit identifier of a recipient key, stored in its ciphertexts' headers
+std::string makeSessionKey(); // draws a fresh hybrid session key
+std::mt19937 sessionKeyGenerator(std::string sessionKey); // seeds the key stream generator for a hybrid session key
+std::string nextKeyStream(std::mt19937& gen, uint32_t len); // draws the next len bytes of a hybrid key stream
+std::string lzCompress(std::string src); // LZ77 compression ahead of asymmetric encoding
+bool lzDecompress(std::string src, std::string& out); // reverses lzCompress, false on malformed input
+void putBE32(std::string& buf, uint32_t val); // appends a big-endian 32 bit integer
+uint32_t getBE32(const std::string& buf, size_t off); // reads a big-endian 32 bit integer
+int benchmark(int argc, char* argv[]); // runs the microbenchmark and thread scaling suite
+int runDaemon(int argc, char* argv[]); // serves encrypt/decrypt requests over a Unix domain socket with warm key state
+int runClient(int argc, char* argv[]); // sends one file to a running daemon and writes back the result
+int keygen(int argc, char* argv[]); // writes a recipient key pair for multi-recipient encryption
+bool readPublicKey(std::string path, Recipient& rcpt); // loads a recipient's modulus from a .pub file
+bool readPrivateKey(std::string path, Trapdoor& td); // loads and checks a recipient's p and q from a .key file
+typedef std::function<std::string(const std::string&, uint64_t)> PipelineTransform; // chunk, offset -> output bytes
+bool runPipeline(const std::string& inPath, const std::string* inData, uint64_t inSkip, const std::string& outPath,
+                 const std::string& outPrefix, uint32_t chunkLen, const PipelineTransform& transform); // overlapped read -> transform -> write
+bool readFileAsync(std::string path, std::string& out); // reads a whole file with large reads in flight
+bool writeFileAsync(std::string path, const std::string& data); // writes a whole buffer with large writes in flight
+const uint32_t pipelineIOChunk = 1024 * 1024; // chunk length for plain reads, writes and XOR
+const uint32_t pipelineEncodeChunk = 16 * 1024; // cleartext chunk length for streamed asymmetric encoding (8 MiB out)
+const uint32_t pipelineDecodeChunk = pipelineEncodeChunk * 64; // ciphertext chunk length for streamed asymmetric decoding
+bool forceThreadIO = false; // --io-threads: skip io_uring and use the thread backend
+
+// Instrumentation
+// Per-phase wall/CPU time, byte and work counters, and isTranslucentElement() early-exit depths, collected when the
+// program is started with --stats PATH and written as JSON after each job. --progress prints a progress/ETA line
+// during long asymmetric jobs. Build with -DROXY_STATS=0 and every probe below compiles to nothing.
+// Phase times are inclusive: xor and binToStr work done while generating elements is also counted under elementGeneration.
+// Pipelined reads and writes overlap with the transform, so they report bytes only; ioWait is time spent blocked on them.
+// A phase's cpu_ms is CPU time of the thread that ran it, where the platform offers a per-thread clock; the job's
+// top-level cpu_ms is process-wide, so it includes worker threads.
+#ifndef ROXY_STATS
+#define ROXY_STATS 1
+#endif
+
+enum StatsPhase { PHASE_READ, PHASE_STRTOBIN, PHASE_BINTOSTR, PHASE_KEYEXPANSION, PHASE_XOR, PHASE_COMPRESSION, PHASE_ELEMENTS, PHASE_MEMBERSHIP, PHASE_WRITE, PHASE_IOWAIT, PHASE_COUNT };
+const char* const statsPhaseNames[PHASE_COUNT] = { "read", "strToBin", "binToStr", "keyExpansion", "xor", "compression", "elementGeneration", "membershipTests", "write", "ioWait" };
+
+#if ROXY_STATS
+struct RoxyStats {
+    bool enabled = false;
+    bool progress = false;
+    std::string path;
+    std::chrono::steady_clock::time_point jobStart, lastProgress;
+    std::clock_t jobCPUStart = 0;
+    bool progressShown = false;
+    bool pipelineProgress = false; // an I/O pipeline is reporting bytes, so element loops stay quiet
+    std::atomic<uint64_t> wallNs[PHASE_COUNT];
+    std::atomic<uint64_t> cpuNs[PHASE_COUNT];
+    std::atomic<uint64_t> bytes[PHASE_COUNT];
+    std::atomic<uint64_t> calls[PHASE_COUNT];
+    std::atomic<uint64_t> translucentElements, randomElements, rsaRounds, membershipTests, inversions;
+    std::atomic<uint64_t> exitDepth[33]; // [i < 32] rejected at round i, [32] accepted as a member
+};
+RoxyStats stats;
+
+// PhaseTimer
+// Scoped probe adding its lifetime to a phase's wall and CPU totals; inert unless stats are enabled.
+// threadCPUNs()
+// PRE: None
+// POST: CPU time consumed so far by the calling thread returned in ns; process CPU time where there is no per-thread clock
+// WARNINGS: Only differences between two readings on the same thread are meaningful
+// STATUS: Completed, tested
+uint64_t threadCPUNs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+    return static_cast<uint64_t>(std::clock() * (1e9 / CLOCKS_PER_SEC));
+}
+
+struct PhaseTimer {
+    StatsPhase phase;
+    std::chrono::steady_clock::time_point wallStart;
+    uint64_t cpuStart;
+    PhaseTimer(StatsPhase ph) : phase(ph), cpuStart(0) {
+        if (stats.enabled) {
+            wallStart = std::chrono::steady_clock::now();
+            cpuStart = threadCPUNs();
+        }
+    }
+    ~PhaseTimer() {
+        if (stats.enabled) {
+            uint64_t wall = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wallStart).count());
+            uint64_t cpu = threadCPUNs() - cpuStart;
+            stats.wallNs[phase].fetch_add(wall, std::memory_order_relaxed);
+            stats.cpuNs[phase].fetch_add(cpu, std::memory_order_relaxed);
+            stats.calls[phase].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+#define STATS_PHASE(phase) PhaseTimer statsPhaseTimer(phase)
+#define STATS_BYTES(phase, n) if (stats.enabled) { stats.bytes[phase].fetch_add((n), std::memory_order_relaxed); }
+#define STATS_COUNT(counter, n) if (stats.enabled) { stats.counter.fetch_add((n), std::memory_order_relaxed); }
+#define STATS_EXIT_DEPTH(depth) if (stats.enabled) { stats.exitDepth[depth].fetch_add(1, std::memory_order_relaxed); }
+#define STATS_PROGRESS(done, total) if (stats.progress && !stats.pipelineProgress) { statsProgress((done), (total), "elements"); }
+#define STATS_PIPELINE_PROGRESS(active, done, total) if (stats.progress) { stats.pipelineProgress = (active); statsProgress((done), (total), "bytes"); }
+#define STATS_BEGIN() statsBegin()
+#define STATS_END(job) statsEnd(job)
+
+// statsBegin()
+// PRE: An encryption or decryption job is starting
+// POST: All counters zeroed and job clocks started
+// WARNINGS: Not safe while another job is being instrumented
+// STATUS: Completed, tested
+void statsBegin() {
+    for (uint32_t i = 0; i < PHASE_COUNT; ++i) {
+        stats.wallNs[i] = 0;
+        stats.cpuNs[i] = 0;
+        stats.bytes[i] = 0;
+        stats.calls[i] = 0;
+    }
+    for (uint32_t i = 0; i < 33; ++i) {
+        stats.exitDepth[i] = 0;
+    }
+    stats.translucentElements = 0;
+    stats.randomElements = 0;
+    stats.rsaRounds = 0;
+    stats.membershipTests = 0;
+    stats.inversions = 0;
+    stats.jobStart = std::chrono::steady_clock::now();
+    stats.lastProgress = stats.jobStart;
+    stats.jobCPUStart = std::clock();
+    stats.progressShown = false;
+}
+
+// statsProgress(uint64_t done, uint64_t total, const char* unit)
+// PRE: --progress passed, done of total units of a long loop completed
+// POST: At most once a second, a progress line with an ETA is redrawn
+// WARNINGS: ETA assumes a constant rate over the remaining units
+// STATUS: Completed, tested
+void statsProgress(uint64_t done, uint64_t total, const char* unit) {
+    auto now = std::chrono::steady_clock::now();
+    if (done < total && now - stats.lastProgress < std::chrono::seconds(1)) {
+        return;
+    }
+    if (done == total && !stats.progressShown) {
+        return;
+    }
+    stats.lastProgress = now;
+    stats.progressShown = true;
+    double elapsed = std::chrono::duration<double>(now - stats.jobStart).count();
+    double eta = done == 0 ? 0.0 : elapsed * (total - done) / done;
+    std::cout << "\rProgress: " << std::fixed << std::setprecision(1) << (100.0 * done / total) << "% (" << done << "/" << total
+              << " " << unit << "), ETA " << std::setprecision(0) << eta << "s   " << std::flush;
+    if (done == total) {
+        std::cout << std::endl;
+    }
+}
+
+// peakRSSKiB()
+// PRE: None
+// POST: Peak resident set size of the process in KiB, or 0 where unsupported
+// WARNINGS: None
+// STATUS: Completed, tested
+uint64_t peakRSSKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// statsEnd(std::string job)
+// PRE: A job begun with statsBegin() has completed
+// POST: If --stats was passed, the job's report is written to its path as JSON
+// WARNINGS: Each job overwrites the previous report
+// STATUS: Completed, tested
+void statsEnd(std::string job) {
+    if (!stats.enabled) {
+        return;
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stats.jobStart).count();
+    double cpuMs = (std::clock() - stats.jobCPUStart) * (1000.0 / CLOCKS_PER_SEC);
+    std::ofstream statsOut(stats.path.c_str());
+    statsOut << std::fixed << std::setprecision(3);
+    statsOut << "{\n  \"job\": \"" << job << "\",\n  \"wall_ms\": " << wallMs << ",\n  \"cpu_ms\": " << cpuMs
+             << ",\n  \"peak_rss_kib\": " << peakRSSKiB() << ",\n  \"phases\": {\n";
+    for (uint32_t i = 0; i < PHASE_COUNT; ++i) {
+        statsOut << "    \"" << statsPhaseNames[i] << "\": {\"calls\": " << stats.calls[i] << ", \"wall_ms\": " << stats.wallNs[i] / 1e6
+                 << ", \"cpu_ms\": " << stats.cpuNs[i] / 1e6 << ", \"bytes\": " << stats.bytes[i] << "}" << (i + 1 < PHASE_COUNT ? ",\n" : "\n");
+    }
+    statsOut << "  },\n  \"counters\": {\"translucent_elements\": " << stats.translucentElements << ", \"random_elements\": " << stats.randomElements
+             << ", \"rsa_rounds\": " << stats.rsaRounds << ", \"membership_tests\": " << stats.membershipTests
+             << ", \"inversions\": " << stats.inversions << "},\n  \"early_exit_depth\": [";
+    for (uint32_t i = 0; i < 33; ++i) {
+        statsOut << stats.exitDepth[i] << (i < 32 ? ", " : "");
+    }
+    statsOut << "]\n}\n";
+    statsOut.close();
+    std::cout << "Statistics written to: " << stats.path << std::endl;
+}
+#else
+#define STATS_PHASE(phase)
+#define STATS_BYTES(phase, n)
+#define STATS_COUNT(counter, n)
+#define STATS_EXIT_DEPTH(depth)
+#define STATS_PROGRESS(done, total)
+#define STATS_PIPELINE_PROGRESS(active, done, total)
+#define STATS_BEGIN()
+#define STATS_END(job)
+#endif
+
 
 
-// main()
-// PRE: Program starts
+// main(int argc, char* argv[])
+// PRE: Program starts, optionally with --bench and benchmark options (see benchmark()), --daemon or --client (see runDaemon()),
+//      --keygen NAME (see keygen()),
+//      or with --stats PATH (per-job JSON statistics), --progress (progress/ETA for long jobs) and/or --io-threads
+//      (thread-based file I/O instead of io_uring)
 // POST: Program halts
 // WARNINGS: None
 // STATUS: Completed, tested
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return benchmark(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--daemon") {
+        return runDaemon(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--client") {
+        return runClient(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--keygen") {
+        return keygen(argc, argv);
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats" && i + 1 < argc) {
+#if ROXY_STATS
+            stats.enabled = true;
+            stats.path = argv[++i];
+#else
+            std::cout << "Warning: built with ROXY_STATS=0, ignoring --stats." << std::endl;
+            ++i;
+#endif
+        }
+        else if (arg == "--progress") {
+#if ROXY_STATS
+            stats.progress = true;
+#else
+            std::cout << "Warning: built with ROXY_STATS=0, ignoring --progress." << std::endl;
+#endif
+        }
+        else if (arg == "--io-threads") {
+            forceThreadIO = true;
+        }
+        else {
+            std::cout << "Error: Unknown option " << arg << "." << std::endl;
+            return 1;
+        }
+    }
     while (1) {
         std::string menChoiceProxy;
         std::cout << "    ____  ____ _  __     " << std::endl;
@@ -117,14 +454,16 @@ void encrypt() {
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::cout << "1. Encrypt with Symmetric System" << std::endl;
     std::cout << "2. Encrypt with Asymmetric System" << std::endl;
+    std::cout << "3. Encrypt with Asymmetric System for Multiple Recipients" << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, menChoiceProxy);
     int menChoice = menChoiceProxy[0] - '0';
-    while (menChoice < 1 || menChoice > 2) {
+    while (menChoice < 1 || menChoice > 3) {
         std::cout << "Invalid choice. Please select a valid option." << std::endl;
         std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
         std::cout << "1. Encrypt with Symmetric System" << std::endl;
         std::cout << "2. Encrypt with Asymmetric System" << std::endl;
+        std::cout << "3. Encrypt with Asymmetric System for Multiple Recipients" << std::endl;
         std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
         std::getline(std::cin, menChoiceProxy);
         menChoice = menChoiceProxy[0] - '0';
@@ -136,6 +475,9 @@ void encrypt() {
     case 2:
         asymmEncrypt();
         break;
+    case 3:
+        asymmEncryptBatch();
+        break;
     default:
         std::cout << "Unexpected Error: Uncaught encryption menu input. Exiting..." << std::endl;
         exit(1);
@@ -187,8 +529,6 @@ void symmEncrypt() {
     std::string key, decoyKey;
     std::string decoy, line;
     std::string outfileName, keyOutName;
-    std::ifstream rawFile, rawKey, rawDecoy;
-    std::ofstream cryptoOut, keyOut;
     std::cout << "Please enter the path to the file you would like encrypted." << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, path);
@@ -200,46 +540,18 @@ void symmEncrypt() {
     std::cout << "Please enter the path to the file containing your true key." << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, keyPath);
-    rawFile.open(path.c_str());
-    if (rawFile.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (rawFile.read(&buf[0], 100)) {
-            out.append(buf, 0, rawFile.gcount());
-        }
-        out.append(buf, 0, rawFile.gcount());
-        line = out;
-        rawFile.close();
-    }
-    else {
+    STATS_BEGIN();
+    if (!readFileAsync(path, line)) {
         std::cout << "Failed to open encryption target. Returning to menu." << std::endl;
-        rawFile.close();
         return;
     }
     std::cout << "Successfully read encryption target." << std::endl;
-    rawKey.open(keyPath.c_str());
-    if (rawKey.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (rawKey.read(&buf[0], 100)) {
-            out.append(buf, 0, rawKey.gcount());
-        }
-        out.append(buf, 0, rawKey.gcount());
-        key = out;
-        rawKey.close();
-    }
-    else {
+    if (!readFileAsync(keyPath, key)) {
         std::cout << "Failed to open key file. Returning to menu." << std::endl;
-        rawKey.close();
         return;
     }
     std::cout << "Successfully read key." << std::endl;
-    if (key.length() > line.length()) {
-        key = key.substr(0, line.length());
-    }
-    else if (key.length() != line.length()) {
-        key = iterativeHash(key, line.length());
-    }
+    key = fitSymmKey(key, line.length());
     std::string asciiKey = key;
     key = strToBin(key);
     line = strToBin(line);
@@ -249,20 +561,8 @@ void symmEncrypt() {
     std::cout << "Note: Decoy cannot exceed length of original cleartext!" << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, decoyPath);
-    rawDecoy.open(decoyPath.c_str());
-    if (rawDecoy.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (rawDecoy.read(&buf[0], 100)) {
-            out.append(buf, 0, rawDecoy.gcount());
-        }
-        out.append(buf, 0, rawDecoy.gcount());
-        decoy = out;
-        rawDecoy.close();
-    }
-    else {
+    if (!readFileAsync(decoyPath, decoy)) {
         std::cout << "Failed to open decoy target. Returning to menu." << std::endl;
-        rawDecoy.close();
         return;
     }
     if (decoy.length() > asciiKey.length()) {
@@ -286,14 +586,11 @@ void symmEncrypt() {
     ciphertext = binToStr(ciphertext);
     key = binToStr(key);
     decoyKey = binToStr(decoyKey);
-    cryptoOut.open(outfileName);
-    cryptoOut << ciphertext;
-    cryptoOut.close();
-    keyOut.open(keyOutName);
-    keyOut << key;
-    keyOut << "\n";
-    keyOut << decoyKey;
-    keyOut.close();
+    if (!writeFileAsync(outfileName, ciphertext) || !writeFileAsync(keyOutName, key + "\n" + decoyKey)) {
+        std::cout << "Failed to write output files. Returning to menu." << std::endl;
+        return;
+    }
+    STATS_END("symmEncrypt");
     std::cout << "Successfully wrote data." << std::endl;
     std::cout << "Ciphertext written to: " << outfileName << std::endl;
     std::cout << "Keys written to: " << keyOutName << std::endl;
@@ -312,9 +609,8 @@ void symmDecrypt() {
     std::string line;
     std::string outfileName, keyfileName;
     std::string menChoiceProxy;
-    std::string key, ciphertext, cleartext;
+    std::string key;
     std::ifstream keyRaw, cipherRaw;
-    std::ofstream outRaw;
     std::cout << "Please enter the path to the file you would like decrypted." << std::endl;
     std::cout << "--------------------------------------------------------" << std::endl;
     std::getline(std::cin, path);
@@ -343,6 +639,7 @@ void symmDecrypt() {
         std::getline(std::cin, menChoiceProxy);
         menChoice = menChoiceProxy[0] - '0';
     }
+    STATS_BEGIN();
     keyRaw.open(keyfileName);
     if (!keyRaw.is_open()) {
         std::cout << "Error: Unable to read keys." << std::endl;
@@ -358,29 +655,22 @@ void symmDecrypt() {
     }
     keyRaw.close();
     cipherRaw.open(path);
-    if (cipherRaw.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (cipherRaw.read(&buf[0], 100)) {
-            out.append(buf, 0, cipherRaw.gcount());
-        }
-        out.append(buf, 0, cipherRaw.gcount());
-        ciphertext = out;
-        cipherRaw.close();
-    }
-    else {
+    if (!cipherRaw.good()) {
         std::cout << "Failed to open cipher target. Returning to menu." << std::endl;
         cipherRaw.close();
         return;
     }
-    key = strToBin(key);
-    ciphertext = strToBin(ciphertext);
-    cleartext = strXOR(key, ciphertext);
-    cleartext = binToStr(cleartext);
+    cipherRaw.close();
     std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
-    outRaw.open(outfileName);
-    outRaw << cleartext;
-    outRaw.close();
+    // streamed: each chunk is XORed against the matching slice of the key while the next is read
+    bool written = runPipeline(path, nullptr, 0, outfileName, "", pipelineIOChunk, [&](const std::string& chunk, uint64_t off) {
+        return symmXOR(chunk, off < key.length() ? key.substr(off, chunk.length()) : std::string());
+    });
+    if (!written) {
+        std::cout << "Failed to write cleartext. Returning to menu." << std::endl;
+        return;
+    }
+    STATS_END("symmDecrypt");
     std::cout << "Data written." << std::endl;
     std::cout << "--------------------------------------------------------" << std::endl;
 }
@@ -395,7 +685,6 @@ void asymmEncrypt() {
     std::string outfileName;
     std::string line;
     std::ifstream rawFile;
-    std::ofstream cryptoOut;
     std::cout << "Please enter the path to the file you would like encrypted." << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, path);
@@ -403,42 +692,232 @@ void asymmEncrypt() {
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
     std::getline(std::cin, outfileName);
     outfileName += ".roxy";
-    rawFile.open(path.c_str());
-    if (rawFile.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (rawFile.read(&buf[0], 100)) {
-            out.append(buf, 0, rawFile.gcount());
-        }
-        out.append(buf, 0, rawFile.gcount());
-        line = out;
+    std::string hybridChoice, decoyPath, compressChoice;
+    std::cout << "Use hybrid mode? Only a session key is encoded asymmetrically; suited to large files. (y/N)" << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, hybridChoice);
+    bool hybrid = !hybridChoice.empty() && (hybridChoice[0] == 'y' || hybridChoice[0] == 'Y');
+    if (hybrid) {
+        std::cout << "Please enter the path to a decoy cleartext, or leave blank for none." << std::endl;
+        std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+        std::getline(std::cin, decoyPath);
+    }
+    bool compress = false;
+    if (decoyPath.empty()) {
+        std::cout << "Compress cleartext before encoding? (Y/n)" << std::endl;
+        std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+        std::getline(std::cin, compressChoice);
+        compress = compressChoice.empty() || (compressChoice[0] != 'n' && compressChoice[0] != 'N');
+    }
+    else {
+        std::cout << "Note: Compression is skipped when a decoy is used, so the decoy key yields the decoy directly." << std::endl;
+    }
+    STATS_BEGIN();
+    uint8_t flags = (compress ? ASYMM_FLAG_COMPRESSED : 0) | (hybrid ? ASYMM_FLAG_HYBRID : 0);
+    std::string decoyKey, decoyOutName = outfileName.substr(0, outfileName.length() - 5) + "-decoy.roxy";
+    bool written;
+    if (!compress && decoyPath.empty()) {
+        // nothing needs the whole cleartext at once, so it is streamed through the encoder chunk by chunk
+        rawFile.open(path.c_str());
+        if (!rawFile.good()) {
+            std::cout << "Unable to open encryption target. Returning to menu..." << std::endl;
+            rawFile.close();
+            return;
+        }
         rawFile.close();
+        std::string prefix = asymmHeader(flags, 0);
+        if (hybrid) {
+            std::string sessionKey = makeSessionKey();
+            std::mt19937 gen = sessionKeyGenerator(sessionKey);
+            std::string keyElements = asymmEncodeKey(sessionKey);
+            if (!elementsBelowModulus(keyElements, 6827 * 4079)) {
+                std::cout << "Error: Session key encoding would reveal key bits. Returning to menu." << std::endl;
+                return;
+            }
+            prefix += keyElements;
+            written = runPipeline(path, nullptr, 0, outfileName, prefix, pipelineIOChunk, [&](const std::string& chunk, uint64_t) {
+                return symmXOR(chunk, nextKeyStream(gen, static_cast<uint32_t>(chunk.length())));
+            });
+        }
+        else {
+            written = runPipeline(path, nullptr, 0, outfileName, prefix, pipelineEncodeChunk, [](const std::string& chunk, uint64_t) {
+                return asymmEncode(chunk);
+            });
+        }
     }
     else {
+        if (!readFileAsync(path, line)) {
+            std::cout << "Unable to open encryption target. Returning to menu..." << std::endl;
+            return;
+        }
+        std::string ciphertext = asymmSeal(line, flags);
+        if ((flags & ASYMM_FLAG_HYBRID) && !elementsBelowModulus(ciphertext.substr(asymmHeaderLen, hybridKeyLen * 8 * 8), 6827 * 4079)) {
+            std::cout << "Error: Session key encoding would reveal key bits. Returning to menu." << std::endl;
+            return;
+        }
+        if (!decoyPath.empty()) {
+            std::string decoy;
+            if (!readFileAsync(decoyPath, decoy)) {
+                std::cout << "Failed to open decoy target. Returning to menu." << std::endl;
+                return;
+            }
+            if (decoy.length() > line.length()) {
+                std::cout << "Decoy too long! Returning to menu." << std::endl;
+                return;
+            }
+            else if (decoy.length() < line.length()) {
+                std::cout << "Proceeding with undersized decoy." << std::endl;
+                std::cout << "Note: Decoy will be padded out with spaces to meet length requirements." << std::endl;
+                decoy.resize(line.length(), ' ');
+            }
+            decoyKey = symmXOR(decoy, ciphertext.substr(ciphertext.length() - line.length()));
+            std::cout << "Successfully derived decoy key." << std::endl;
+        }
+        written = writeFileAsync(outfileName, ciphertext) && (decoyKey.empty() || writeFileAsync(decoyOutName, decoyKey));
+    }
+    if (!written) {
+        std::cout << "Failed to write ciphertext. Returning to menu." << std::endl;
+        return;
+    }
+    STATS_END("asymmEncrypt");
+    std::cout << "Successfully wrote data." << std::endl;
+    std::cout << "Ciphertext written to: " << outfileName << std::endl;
+    if (!decoyKey.empty()) {
+        std::cout << "Decoy key written to: " << decoyOutName << std::endl;
+    }
+    std::cout << "Retain original ciphertext outfile. Otherwise, data loss may occur." << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+}
+
+// asymmEncryptBatch()
+// PRE: User selected to asymmetrically encrypt for multiple recipients
+// POST: One ciphertext per recipient outputted, named <output>-<key name>.roxy
+// WARNINGS: Recipients' ciphertexts are derived from one shared entropy pool, each under its own salt
+// STATUS: completed, tested
+void asymmEncryptBatch() {
+    std::string path, outfileName, listPath;
+    std::string line, list;
+    std::string hybridChoice, compressChoice;
+    std::cout << "Please enter the path to the file you would like encrypted." << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, path);
+    std::cout << "Please enter the name of the output file:" << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, outfileName);
+    std::cout << "Please enter the path to the recipient list, one public key file per line." << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, listPath);
+    std::cout << "Use hybrid mode? Only a session key is encoded asymmetrically; suited to large files. (y/N)" << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, hybridChoice);
+    bool hybrid = !hybridChoice.empty() && (hybridChoice[0] == 'y' || hybridChoice[0] == 'Y');
+    std::cout << "Compress cleartext before encoding? (Y/n)" << std::endl;
+    std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
+    std::getline(std::cin, compressChoice);
+    bool compress = compressChoice.empty() || (compressChoice[0] != 'n' && compressChoice[0] != 'N');
+    STATS_BEGIN();
+    if (!readFileAsync(listPath, list)) {
+        std::cout << "Unable to open recipient list. Returning to menu..." << std::endl;
+        return;
+    }
+    std::vector<Recipient> recipients;
+    std::istringstream listStream(list);
+    std::string keyPath;
+    while (std::getline(listStream, keyPath)) {
+        keyPath.erase(std::remove(keyPath.begin(), keyPath.end(), '\r'), keyPath.end());
+        if (keyPath.empty()) {
+            continue;
+        }
+        Recipient rcpt;
+        if (!readPublicKey(keyPath, rcpt)) {
+            std::cout << "Unable to read public key " << keyPath << ". Returning to menu..." << std::endl;
+            return;
+        }
+        for (size_t r = 0; r < recipients.size(); ++r) {
+            if (recipients[r].name == rcpt.name) {
+                std::cout << "Two recipients are named " << rcpt.name << " and would share an output file; rename one of their .pub files. Returning to menu..." << std::endl;
+                return;
+            }
+        }
+        recipients.push_back(rcpt);
+    }
+    if (recipients.empty()) {
+        std::cout << "No recipients listed. Returning to menu..." << std::endl;
+        return;
+    }
+    if (!readFileAsync(path, line)) {
         std::cout << "Unable to open encryption target. Returning to menu..." << std::endl;
-        rawFile.close();
         return;
     }
-    std::string bitstr;
-    for (uint32_t i = 0; i < line.length(); ++i) {
-        bitstr += std::bitset<8>(line[i]).to_string();
+    // everything up to the bitstring and entropy pool is done once and shared by every recipient
+    uint8_t flags = ASYMM_FLAG_RECIPIENT | (compress ? ASYMM_FLAG_COMPRESSED : 0) | (hybrid ? ASYMM_FLAG_HYBRID : 0);
+    std::string bulk;
+    flags = asymmPrepare(line, flags, bulk);
+    std::string bitstr = strToBin(line);
+    std::vector<uint32_t> pool = fillEntropyPool(bitstr.length() * 2);
+    std::vector<uint32_t> salts(recipients.size());
+    std::random_device rd;
+    for (size_t r = 0; r < salts.size(); ++r) {
+        salts[r] = rd();
     }
-    std::string ciphertext;
-    for (uint32_t i = 0; i < bitstr.length(); ++i) {
-        if (bitstr[i] == '1') {
-            ciphertext += constructTranslucentElement();
+
+    // workers encode a recipient each; finished streams are written here while the rest are still encoding
+    std::atomic<size_t> nextRecipient(0);
+    std::mutex lock;
+    std::condition_variable encoded;
+    std::queue<std::pair<size_t, std::string>> finished;
+    uint32_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+    workerCount = static_cast<uint32_t>(std::min<size_t>(workerCount, recipients.size()));
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&]() {
+            size_t r;
+            while ((r = nextRecipient++) < recipients.size()) {
+                std::string elements = asymmEncodeBits(bitstr, recipients[r].n, pool, salts[r]);
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    finished.push(std::make_pair(r, std::move(elements)));
+                }
+                encoded.notify_one();
+            }
+        });
+    }
+    size_t failures = 0;
+    for (size_t written = 0; written < recipients.size(); ++written) {
+        std::pair<size_t, std::string> job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            encoded.wait(guard, [&]() { return !finished.empty(); });
+            job = std::move(finished.front());
+            finished.pop();
+        }
+        std::string outName = outfileName + "-" + recipients[job.first].name + ".roxy";
+        if (!elementsBelowModulus(job.second, recipients[job.first].n)) {
+            std::cout << "Error: Encoding for " << recipients[job.first].name << " would reveal cleartext bits. Skipping." << std::endl;
+            ++failures;
+            continue;
+        }
+        // hybrid streams share one bulk payload behind each recipient's encoded session key
+        const std::string& body = hybrid ? bulk : job.second;
+        std::string header = asymmHeader(flags, recipientKeyId(recipients[job.first].n));
+        std::string prefix = hybrid ? header + job.second : header;
+        bool ok = runPipeline("", &body, 0, outName, prefix, pipelineIOChunk, [](const std::string& chunk, uint64_t) {
+            return chunk;
+        });
+        if (ok) {
+            std::cout << "Ciphertext for " << recipients[job.first].name << " written to: " << outName << std::endl;
         }
         else {
-            ciphertext += randomAsymmElement();
+            std::cout << "Failed to write ciphertext for " << recipients[job.first].name << "." << std::endl;
+            ++failures;
         }
     }
-    ciphertext = binToStr(ciphertext);
-    cryptoOut.open(outfileName.c_str());
-    cryptoOut << ciphertext;
-    cryptoOut.close();
-    std::cout << "Successfully wrote data." << std::endl;
-    std::cout << "Ciphertext written to: " << outfileName << std::endl;
-    std::cout << "Retain original ciphertext outfile. Otherwise, data loss may occur." << std::endl;
+    for (size_t w = 0; w < workers.size(); ++w) {
+        workers[w].join();
+    }
+    STATS_END("asymmEncryptBatch");
+    std::cout << "Encrypted for " << recipients.size() - failures << " of " << recipients.size() << " recipients." << std::endl;
+    std::cout << "Each recipient decrypts with the private key from their --keygen pair." << std::endl;
     std::cout << "++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << std::endl;
 }
 
@@ -453,191 +932,707 @@ void asymmDecrypt() {
     std::string outfileName;
     std::string line;
     std::ifstream rawFile;
-    std::ofstream clearOut;
     std::cout << "Please enter the path to the file you would like decrypted." << std::endl;
     std::cout << "--------------------------------------------------------" << std::endl;
     std::getline(std::cin, path);
     std::cout << "Please enter the name of the output file:" << std::endl;
     std::cout << "--------------------------------------------------------" << std::endl;
     std::getline(std::cin, outfileName);
-    rawFile.open(path.c_str());
-    if (rawFile.good()) {
-        auto out = std::string();
-        auto buf = std::string(100, '\0');
-        while (rawFile.read(&buf[0], 100)) {
-            out.append(buf, 0, rawFile.gcount());
-        }
-        out.append(buf, 0, rawFile.gcount());
-        line = out;
-        rawFile.close();
+    STATS_BEGIN();
+    // only the header and any hybrid session key are read up front; the rest is streamed unless it is compressed
+    std::string head(asymmHeaderLen + hybridKeyLen * 8 * 8, '\0');
+    rawFile.open(path.c_str(), std::ios::binary);
+    rawFile.read(&head[0], head.length());
+    head.resize(static_cast<size_t>(rawFile.gcount()));
+    rawFile.close();
+    STATS_BYTES(PHASE_READ, head.length());
+    std::string body = head;
+    uint8_t flags;
+    uint16_t keyId;
+    bool known = asymmStripHeader(body, flags, keyId);
+    uint64_t bodyStart = head.length() - body.length();
+    uint32_t keyElements = hybridKeyLen * 8 * 8;
+    int menChoice = 1;
+    if (known && (flags & ASYMM_FLAG_HYBRID)) {
+        std::string menChoiceProxy;
+        std::cout << "Hybrid ciphertext found. Please select an option below:" << std::endl;
+        std::cout << "--------------------------------------------------------" << std::endl;
+        std::cout << "1. Decrypt with Trapdoor" << std::endl;
+        std::cout << "2. Decrypt with Decoy Key" << std::endl;
+        std::cout << "--------------------------------------------------------" << std::endl;
+        std::getline(std::cin, menChoiceProxy);
+        menChoice = menChoiceProxy[0] - '0';
+        while (menChoice < 1 || menChoice > 2) {
+            std::cout << "Invalid choice. Please select a valid option." << std::endl;
+            std::cout << "--------------------------------------------------------" << std::endl;
+            std::cout << "1. Decrypt with Trapdoor" << std::endl;
+            std::cout << "2. Decrypt with Decoy Key" << std::endl;
+            std::cout << "--------------------------------------------------------" << std::endl;
+            std::getline(std::cin, menChoiceProxy);
+            menChoice = menChoiceProxy[0] - '0';
+        }
     }
-    line = strToBin(line);
-    std::string bitBuffer, out;
-    for (uint32_t i = 0; i < (line.length() / 64); ++i) {
-        bitBuffer = line.substr(i * 64, 64);
-        if (isTranslucentElement(bitBuffer, p, q)) {
-            out += '1';
+    Trapdoor td = makeTrapdoor(p, q);
+    if (menChoice == 1 && known && (flags & ASYMM_FLAG_RECIPIENT)) {
+        std::string keyPath;
+        std::cout << "Ciphertext was encrypted for a recipient key. Please enter the path to your private key file." << std::endl;
+        std::cout << "--------------------------------------------------------" << std::endl;
+        std::getline(std::cin, keyPath);
+        if (!readPrivateKey(keyPath, td)) {
+            std::cout << "Error: Unable to read a valid private key. Returning to menu." << std::endl;
+            return;
         }
-        else {
-            out += '0';
+        if (recipientKeyId(td.n) != keyId) {
+            std::cout << "Error: That private key does not belong to the recipient of this ciphertext. Returning to menu." << std::endl;
+            return;
         }
     }
-    std::string outText = binToStr(out);
-    std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
-    clearOut.open(outfileName);
-    clearOut << outText;
-    clearOut.close();
+    bool written;
+    if (menChoice == 2) {
+        std::string keyPath, decoyKey;
+        std::cout << "Please enter the path to your decoy key file." << std::endl;
+        std::cout << "--------------------------------------------------------" << std::endl;
+        std::getline(std::cin, keyPath);
+        if (!readFileAsync(keyPath, decoyKey)) {
+            std::cout << "Error: Unable to read keys." << std::endl;
+            return;
+        }
+        if (body.length() < keyElements) {
+            std::cout << "Failed to restore cleartext; the ciphertext may be corrupted. Returning to menu." << std::endl;
+            return;
+        }
+        std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
+        written = runPipeline(path, nullptr, bodyStart + keyElements, outfileName, "", pipelineIOChunk, [&](const std::string& chunk, uint64_t off) {
+            return symmXOR(chunk, off < decoyKey.length() ? decoyKey.substr(off, chunk.length()) : std::string());
+        });
+    }
+    else if (!known || (flags & ASYMM_FLAG_COMPRESSED)) {
+        // decompression needs the whole decoded stream, so the ciphertext is read whole
+        std::string outText;
+        if (!readFileAsync(path, line) || !asymmOpen(line, td, outText)) {
+            std::cout << "Failed to restore cleartext; the ciphertext may be corrupted. Returning to menu." << std::endl;
+            return;
+        }
+        std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
+        written = writeFileAsync(outfileName, outText);
+    }
+    else if (flags & ASYMM_FLAG_HYBRID) {
+        if (body.length() < keyElements) {
+            std::cout << "Failed to restore cleartext; the ciphertext may be corrupted. Returning to menu." << std::endl;
+            return;
+        }
+        std::mt19937 gen = sessionKeyGenerator(asymmDecode(body.substr(0, keyElements), td));
+        std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
+        written = runPipeline(path, nullptr, bodyStart + keyElements, outfileName, "", pipelineIOChunk, [&](const std::string& chunk, uint64_t) {
+            return symmXOR(chunk, nextKeyStream(gen, static_cast<uint32_t>(chunk.length())));
+        });
+    }
+    else {
+        std::cout << "Writing cleartext to " << outfileName << "..." << std::endl;
+        written = runPipeline(path, nullptr, bodyStart, outfileName, "", pipelineDecodeChunk, [&](const std::string& chunk, uint64_t) {
+            return asymmDecode(chunk, td);
+        });
+    }
+    if (!written) {
+        std::cout << "Failed to restore cleartext; the ciphertext could not be read or written. Returning to menu." << std::endl;
+        return;
+    }
+    STATS_END("asymmDecrypt");
     std::cout << "Data written." << std::endl;
     std::cout << "--------------------------------------------------------" << std::endl;
 }
 
-// customHash(int32_t num)
-// PRE: 32 bit integer is passed
-// POST: 32 bits of hashed data yielded
-// WARNINGS: collisions may occur - collision resistance not tested
-// STATUS: Completed, tested.
-// Attribution: sourced from https://www.cs.ubc.ca/~rbridson/docs/schechter-sca08-turbulence.pdf
-uint32_t customHash(uint32_t num) {
-    num = num ^ 2747636419;
-    num = (num * 2654435769) % UINT32_MAX;
-    num = num ^ (num >> 16);
-    num = (num * 2654435769) % UINT32_MAX;
-    num = num ^ (num >> 16);
-    num = (num * 2654435769) % UINT32_MAX;
-    return num;
+// fitSymmKey(std::string key, uint32_t tarlen)
+// PRE: key read from the user's keyfile
+// POST: key truncated or deterministically padded to tarlen bytes
+// WARNINGS: None
+// STATUS: Completed, tested
+std::string fitSymmKey(std::string key, uint32_t tarlen) {
+    STATS_PHASE(PHASE_KEYEXPANSION);
+    STATS_BYTES(PHASE_KEYEXPANSION, tarlen);
+    if (key.length() > tarlen) {
+        return key.substr(0, tarlen);
+    }
+    return iterativeHash(key, tarlen);
 }
 
-// iterativeHash(std::string key, uint32_t tarlen)
-// PRE: key pas sed as a string
-// POST: key padded to n bytes with deterministic pseudorandomness
-// WARNINGS: collisions may occur - collision resistance not tested
-// STATUS: Completed, tested.
-std::string iterativeHash(std::string key, uint32_t tarlen) {
-    if (key.length() == tarlen) {
-        return key;
-    }
-    uint32_t baseNum(0);
-    // this should fix the ordering issue
-    for (size_t i = 0; i < key.length(); ++i) {
-        baseNum += static_cast<uint32_t>(key[i]) * i;
+// symmXOR(std::string text, std::string key)
+// PRE: text and key are raw character strings of equal length
+// POST: text XOR key returned as raw characters, a byte at a time rather than via bitstrings
+// WARNINGS: bytes of text past the end of key are passed through unchanged
+// STATUS: Completed, tested
+std::string symmXOR(std::string text, std::string key) {
+    STATS_PHASE(PHASE_XOR);
+    STATS_BYTES(PHASE_XOR, text.length());
+    size_t len = std::min(text.length(), key.length());
+    for (size_t i = 0; i < len; ++i) {
+        text[i] = static_cast<char>(text[i] ^ key[i]);
     }
-    // hash basenum
-    uint32_t base = customHash(baseNum);
-    std::mt19937 gen(base); // seed the generator
-    std::uniform_int_distribution<> distr(32, 255);
-    char randomAppend = static_cast<char>(distr(gen));
-    key += randomAppend;
-    return iterativeHash(key, tarlen);
+    return text;
 }
 
-// strXOR(std::string r, std::string k)
-// PRE: r, k are 4 char strings representing binary numbers
-// POST: result of r XOR k is returned.
-// WARNING: Different length inputs may yield bad results
+// asymmEncode(std::string cleartext)
+// PRE: raw cleartext passed
+// POST: one 64 bit element per cleartext bit returned as raw characters
+// WARNINGS: 512x expansion of the cleartext
 // STATUS: Completed, tested
-std::string strXOR(std::string r, std::string k) {
-    std::string retStr = "";
-    for (size_t i = 0; i < r.length(); i++) {
-        if (r[i] == '1' || k[i] == '1') {
-            if (r[i] == '1' && k[i] == '1') {
-                retStr.append("0");
+std::string asymmEncode(std::string cleartext) {
+    std::string bitstr = strToBin(cleartext);
+    std::string ciphertext;
+    {
+        STATS_PHASE(PHASE_ELEMENTS);
+        STATS_BYTES(PHASE_ELEMENTS, cleartext.length());
+        for (uint32_t i = 0; i < bitstr.length(); ++i) {
+            if (bitstr[i] == '1') {
+                ciphertext += constructTranslucentElement();
             }
             else {
-                retStr.append("1");
+                ciphertext += randomAsymmElement();
             }
-        }
-        else {
-            retStr.append("0");
+            STATS_PROGRESS(i + 1, bitstr.length());
         }
     }
-    return retStr;
+    return binToStr(ciphertext);
 }
 
-// strToBin(std::string str)
-// PRE: A string is passed containing valid characters
-// POST: A bitstring of those characters is returned
-// WARNING: Invalid data types may be corrupted via this process.
+// asymmDecode(std::string ciphertext, const Trapdoor& td)
+// PRE: raw ciphertext + precomputed trapdoor passed
+// POST: cleartext recovered by testing each 64 bit element for membership in St
+// WARNINGS: 1/2^32 chance of a bitflip per element
 // STATUS: Completed, tested
-std::string strToBin(std::string str) {
-    std::string binStr = "";
-    for (uint32_t i = 0; i < str.length(); ++i) {
-        binStr.append(std::bitset<8>(str[i]).to_string());
+std::string asymmDecode(std::string ciphertext, const Trapdoor& td) {
+    std::string line = strToBin(ciphertext);
+    std::string bitBuffer, out;
+    {
+        STATS_PHASE(PHASE_MEMBERSHIP);
+        STATS_BYTES(PHASE_MEMBERSHIP, ciphertext.length());
+        for (uint32_t i = 0; i < (line.length() / 64); ++i) {
+            bitBuffer = line.substr(i * 64, 64);
+            if (isTranslucentElement(bitBuffer, td)) {
+                out += '1';
+            }
+            else {
+                out += '0';
+            }
+            STATS_PROGRESS(i + 1, line.length() / 64);
+        }
     }
-    return binStr;
+    return binToStr(out);
 }
 
-// binToStr(std::string str)
-// PRE: A string of bits is passed
-// POST: A char converted string is returned
-// WARNING: Invalid data types may be corrupted via this process.
+// putBE32(std::string& buf, uint32_t val)
+// PRE: output buffer and value passed
+// POST: val appended to buf as 4 big-endian bytes
+// WARNINGS: None
 // STATUS: Completed, tested
-std::string binToStr(std::string str) {
-    std::string retStr;
-    while (str.length() >= 8) {
-        std::string testing = str.substr(0, 8);
-        int num = std::stoi(str.substr(0, 8), 0, 2);
-        char myChar = static_cast<char>(num);
-        retStr += myChar;
-        str = str.substr(8, str.length()-8);
-    }
-    return retStr;
+void putBE32(std::string& buf, uint32_t val) {
+    buf += static_cast<char>((val >> 24) & 0xFF);
+    buf += static_cast<char>((val >> 16) & 0xFF);
+    buf += static_cast<char>((val >> 8) & 0xFF);
+    buf += static_cast<char>(val & 0xFF);
 }
 
-// rsa(uint32_t p, uint32_t q, uint32_t seed)
-// PRE: User is encrypting asymmetrically
-// POST: valid RSA ciphertext returned
-// WARNINGS: Large quantities of p,q,seed may result in overflow
+// getBE32(const std::string& buf, size_t off)
+// PRE: buf holds at least off + 4 bytes
+// POST: the big-endian integer at off returned
+// WARNINGS: None
 // STATUS: Completed, tested
-uint32_t rsa(uint32_t p, uint32_t q, uint32_t seed) {
-    uint32_t n = p * q;
-    uint32_t phi = (p - 1) * (q - 1);
-    uint32_t e = 17;
-    
-    uint64_t ciphertext = 1;
-    for (uint32_t i = 0; i < e; ++i) {
-        ciphertext = (ciphertext * seed) % n;
-    }
+uint32_t getBE32(const std::string& buf, size_t off) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(buf[off])) << 24) | (static_cast<uint32_t>(static_cast<unsigned char>(buf[off + 1])) << 16)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(buf[off + 2])) << 8) | static_cast<uint32_t>(static_cast<unsigned char>(buf[off + 3]));
+}
 
-    return ciphertext;
+// lzPutLength(std::string& out, uint32_t len)
+// PRE: the 4 bit token field for len is saturated at 15
+// POST: the remainder len - 15 appended as a run of 255s and a final byte
+// WARNINGS: None
+// STATUS: Completed, tested
+void lzPutLength(std::string& out, uint32_t len) {
+    len -= 15;
+    while (len >= 255) {
+        out += static_cast<char>(255);
+        len -= 255;
+    }
+    out += static_cast<char>(len);
 }
 
-// constructTranslucentElement()
-// PRE: 1 is selected for encoding
-// POST: A set element is constructed per Canetti et. al. construction 2
-// WARNING: Time-based seeding produces vulnerabilities, should be quelled with BBS
+// lzCompress(std::string src)
+// PRE: raw data passed
+// POST: big-endian original length followed by LZ77 sequences returned. Each sequence is a token byte
+//       (literal count << 4 | match length - 4, either saturating at 15 with the rest appended as 255-runs),
+//       the literals, then a 2 byte little-endian match offset and any extended match length.
+//       The final sequence carries literals only.
+// WARNINGS: Greedy single-candidate matching; favours speed over ratio
+// STATUS: Completed, tested
+std::string lzCompress(std::string src) {
+    STATS_PHASE(PHASE_COMPRESSION);
+    STATS_BYTES(PHASE_COMPRESSION, src.length());
+    const uint32_t minMatch = 4, hashBits = 16, maxOffset = 65535;
+    std::string out;
+    putBE32(out, static_cast<uint32_t>(src.length()));
+    std::vector<int64_t> table(static_cast<size_t>(1) << hashBits, -1);
+    auto read32 = [&](size_t pos) {
+        uint32_t val;
+        std::memcpy(&val, src.data() + pos, 4);
+        return val;
+    };
+    size_t anchor = 0, i = 0;
+    while (i + minMatch <= src.length()) {
+        uint32_t seq = read32(i);
+        uint32_t h = (seq * 2654435761u) >> (32 - hashBits);
+        int64_t cand = table[h];
+        table[h] = static_cast<int64_t>(i);
+        if (cand < 0 || i - cand > maxOffset || read32(cand) != seq) {
+            ++i;
+            continue;
+        }
+        size_t match = minMatch;
+        while (i + match < src.length() && src[cand + match] == src[i + match]) {
+            ++match;
+        }
+        uint32_t lits = static_cast<uint32_t>(i - anchor);
+        uint32_t extra = static_cast<uint32_t>(match - minMatch);
+        out += static_cast<char>((std::min(lits, 15u) << 4) | std::min(extra, 15u));
+        if (lits >= 15) {
+            lzPutLength(out, lits);
+        }
+        out.append(src, anchor, lits);
+        uint32_t offset = static_cast<uint32_t>(i - cand);
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if (extra >= 15) {
+            lzPutLength(out, extra);
+        }
+        i += match;
+        anchor = i;
+    }
+    uint32_t lits = static_cast<uint32_t>(src.length() - anchor);
+    out += static_cast<char>(std::min(lits, 15u) << 4);
+    if (lits >= 15) {
+        lzPutLength(out, lits);
+    }
+    out.append(src, anchor, lits);
+    return out;
+}
+
+// lzDecompress(std::string src, std::string& out)
+// PRE: output of lzCompress passed
+// POST: original data written to out; false returned if src is truncated or malformed
+// WARNINGS: None
+// STATUS: Completed, tested
+bool lzDecompress(std::string src, std::string& out) {
+    STATS_PHASE(PHASE_COMPRESSION);
+    out.clear();
+    if (src.length() < 4) {
+        return false;
+    }
+    uint32_t total = getBE32(src, 0);
+    out.reserve(std::min<size_t>(total, src.length() * 255));
+    size_t ip = 4;
+    auto getLength = [&](uint32_t& len) {
+        unsigned char b;
+        do {
+            if (ip >= src.length()) {
+                return false;
+            }
+            b = static_cast<unsigned char>(src[ip++]);
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+    while (ip < src.length()) {
+        unsigned char token = static_cast<unsigned char>(src[ip++]);
+        uint32_t lits = token >> 4;
+        if (lits == 15 && !getLength(lits)) {
+            return false;
+        }
+        if (src.length() - ip < lits || out.length() + lits > total) {
+            return false;
+        }
+        out.append(src, ip, lits);
+        ip += lits;
+        if (ip == src.length()) {
+            break;
+        }
+        if (src.length() - ip < 2) {
+            return false;
+        }
+        uint32_t offset = static_cast<unsigned char>(src[ip]) | (static_cast<uint32_t>(static_cast<unsigned char>(src[ip + 1])) << 8);
+        ip += 2;
+        uint32_t match = token & 0x0F;
+        if (match == 15 && !getLength(match)) {
+            return false;
+        }
+        match += 4;
+        if (offset == 0 || offset > out.length() || out.length() + match > total) {
+            return false;
+        }
+        // byte at a time, since a match may overlap the bytes it is producing
+        size_t from = out.length() - offset;
+        for (uint32_t j = 0; j < match; ++j) {
+            out += out[from + j];
+        }
+    }
+    STATS_BYTES(PHASE_COMPRESSION, out.length());
+    return out.length() == total;
+}
+
+// asymmSeal(std::string cleartext, uint8_t flags)
+// PRE: raw cleartext passed, along with the ASYMM_FLAG_* stages requested
+// POST: asymmetric header followed by the body returned. The compressed flag is only set, and the compressed
+//       form only used, when it is smaller than the cleartext. In hybrid mode the body is a fresh random session
+//       key encoded as elements, followed by the cleartext XORed with expandSessionKey() of it.
+// WARNINGS: 512x expansion of whatever is encoded; hybrid mode bounds that to the session key
+// STATUS: Completed, tested
+std::string asymmSeal(std::string cleartext, uint8_t flags) {
+    std::string bulk;
+    flags = asymmPrepare(cleartext, flags, bulk);
+    std::string header = asymmHeader(flags, 0);
+    return header + ((flags & ASYMM_FLAG_HYBRID) ? asymmEncodeKey(cleartext) : asymmEncode(cleartext)) + bulk;
+}
+
+// asymmEncodeKey(std::string sessionKey)
+// PRE: hybrid session key passed
+// POST: session key encoded as elements for the built-in trapdoor, as asymmEncode() would lay them out
+// WARNINGS: Every element draws its own words from std::random_device. asymmEncode() seeds from time(0), so the 256
+//           elements of a key would take only one or two distinct values and give the key away.
+// STATUS: Completed, tested
+std::string asymmEncodeKey(std::string sessionKey) {
+    uint32_t p = 6827, q = 4079;
+    std::string bitstr = strToBin(sessionKey);
+    std::random_device rd;
+    std::vector<uint32_t> pool(bitstr.length() * 2);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i] = rd();
+    }
+    return asymmEncodeBits(bitstr, p * q, pool, rd());
+}
+
+// asymmPrepare(std::string& cleartext, uint8_t flags, std::string& bulk)
+// PRE: raw cleartext passed, along with the ASYMM_FLAG_* stages requested
+// POST: cleartext replaced with what is to be encoded as elements, and bulk set to what follows the elements
+//       unencoded. Compression is applied first, and kept only when it is smaller; in hybrid mode cleartext becomes
+//       a fresh session key and bulk the payload XORed with its key stream. The flags actually applied are returned.
+// WARNINGS: None
+// STATUS: Completed, tested
+uint8_t asymmPrepare(std::string& cleartext, uint8_t flags, std::string& bulk) {
+    bulk.clear();
+    if (flags & ASYMM_FLAG_COMPRESSED) {
+        std::string packed = lzCompress(cleartext);
+        if (packed.length() < cleartext.length()) {
+            cleartext = packed;
+        }
+        else {
+            flags &= ~ASYMM_FLAG_COMPRESSED;
+        }
+    }
+    if (flags & ASYMM_FLAG_HYBRID) {
+        std::string sessionKey = makeSessionKey();
+        bulk = symmXOR(cleartext, expandSessionKey(sessionKey, static_cast<uint32_t>(cleartext.length())));
+        cleartext = sessionKey;
+    }
+    return flags;
+}
+
+// asymmStripHeader(std::string& ciphertext, uint8_t& flags, uint16_t& keyId)
+// PRE: raw ciphertext passed
+// POST: header removed and its flags and recipient key id returned; headerless ciphertexts are left as is with no
+//       flags. false returned for a header of an unknown version.
+// WARNINGS: None
+// STATUS: Completed, tested
+bool asymmStripHeader(std::string& ciphertext, uint8_t& flags, uint16_t& keyId) {
+    flags = 0;
+    keyId = 0;
+    if (ciphertext.length() >= asymmHeaderLen && ciphertext.compare(0, 4, asymmMagic) == 0) {
+        if (static_cast<uint8_t>(ciphertext[4]) != asymmVersion) {
+            return false;
+        }
+        flags = static_cast<uint8_t>(ciphertext[5]);
+        keyId = static_cast<uint16_t>((static_cast<uint8_t>(ciphertext[6]) << 8) | static_cast<uint8_t>(ciphertext[7]));
+        ciphertext.erase(0, asymmHeaderLen);
+    }
+    return true;
+}
+
+// asymmOpen(std::string ciphertext, const Trapdoor& td, std::string& cleartext)
+// PRE: raw ciphertext + precomputed trapdoor passed; headerless ciphertexts from earlier versions are accepted
+// POST: cleartext recovered into cleartext, decoding the session key first if hybrid and decompressing if flagged;
+//       false returned if that fails, or if the ciphertext is for a recipient key other than td
+// WARNINGS: A single bitflip in a compressed stream usually makes decompression fail, and one in a hybrid
+//           session key garbles the whole bulk payload
+// STATUS: Completed, tested
+bool asymmOpen(std::string ciphertext, const Trapdoor& td, std::string& cleartext) {
+    uint8_t flags;
+    uint16_t keyId;
+    if (!asymmStripHeader(ciphertext, flags, keyId)) {
+        return false;
+    }
+    if ((flags & ASYMM_FLAG_RECIPIENT) && keyId != recipientKeyId(td.n)) {
+        return false;
+    }
+    if (flags & ASYMM_FLAG_HYBRID) {
+        uint32_t keyElements = hybridKeyLen * 8 * 8;
+        if (ciphertext.length() < keyElements) {
+            return false;
+        }
+        std::string sessionKey = asymmDecode(ciphertext.substr(0, keyElements), td);
+        ciphertext.erase(0, keyElements);
+        cleartext = symmXOR(ciphertext, expandSessionKey(sessionKey, static_cast<uint32_t>(ciphertext.length())));
+    }
+    else {
+        cleartext = asymmDecode(ciphertext, td);
+    }
+    if (flags & ASYMM_FLAG_COMPRESSED) {
+        std::string packed = cleartext;
+        return lzDecompress(packed, cleartext);
+    }
+    return true;
+}
+
+// expandSessionKey(std::string sessionKey, uint32_t len)
+// PRE: hybrid session key passed
+// POST: len bytes of key stream returned, from an mt19937 seeded with every byte of the session key
+// WARNINGS: mt19937 is not a cryptographic stream cipher; like the rest of ROXy, this is a toy
+// STATUS: Completed, tested
+std::string expandSessionKey(std::string sessionKey, uint32_t len) {
+    std::mt19937 gen = sessionKeyGenerator(sessionKey);
+    return nextKeyStream(gen, len);
+}
+
+// asymmHeader(uint8_t flags, uint16_t keyId)
+// PRE: header flags and, for ASYMM_FLAG_RECIPIENT, the recipient's key id passed (0 otherwise)
+// POST: magic, version, flags and key id returned, asymmHeaderLen bytes in all
+// WARNINGS: None
+// STATUS: Completed, tested
+std::string asymmHeader(uint8_t flags, uint16_t keyId) {
+    std::string header = asymmMagic;
+    header += static_cast<char>(asymmVersion);
+    header += static_cast<char>(flags);
+    header += static_cast<char>(keyId >> 8);
+    header += static_cast<char>(keyId & 0xFF);
+    return header;
+}
+
+// recipientKeyId(uint32_t n)
+// PRE: recipient modulus passed
+// POST: 16 bit key id returned, so that decryption can tell a mismatched private key before decoding
+// WARNINGS: Only 16 bits: distinct keys collide 1 time in 65536
+// STATUS: Completed, tested
+uint16_t recipientKeyId(uint32_t n) {
+    return static_cast<uint16_t>(customHash(n) >> 16);
+}
+
+// makeSessionKey()
+// PRE: None
+// POST: hybridKeyLen bytes drawn from std::random_device returned
+// WARNINGS: None
+// STATUS: Completed, tested
+std::string makeSessionKey() {
+    std::random_device rd;
+    std::string sessionKey(hybridKeyLen, '\0');
+    for (uint32_t i = 0; i < hybridKeyLen; ++i) {
+        sessionKey[i] = static_cast<char>(rd() & 0xFF);
+    }
+    return sessionKey;
+}
+
+// sessionKeyGenerator(std::string sessionKey)
+// PRE: hybrid session key passed
+// POST: mt19937 seeded with every byte of the session key returned
+// WARNINGS: None
+// STATUS: Completed, tested
+std::mt19937 sessionKeyGenerator(std::string sessionKey) {
+    std::vector<uint32_t> words(sessionKey.begin(), sessionKey.end());
+    std::seed_seq seq(words.begin(), words.end());
+    return std::mt19937(seq);
+}
+
+// nextKeyStream(std::mt19937& gen, uint32_t len)
+// PRE: generator from sessionKeyGenerator passed
+// POST: next len bytes of key stream returned, four per generator word, low byte first
+// WARNINGS: The stream only lines up with expandSessionKey if every call but the last asks for a multiple of 4 bytes
+// STATUS: Completed, tested
+std::string nextKeyStream(std::mt19937& gen, uint32_t len) {
+    STATS_PHASE(PHASE_KEYEXPANSION);
+    STATS_BYTES(PHASE_KEYEXPANSION, len);
+    std::string stream(len, '\0');
+    for (uint32_t i = 0; i < len; i += 4) {
+        uint32_t word = gen();
+        for (uint32_t j = 0; j < 4 && i + j < len; ++j) {
+            stream[i + j] = static_cast<char>((word >> (8 * j)) & 0xFF);
+        }
+    }
+    return stream;
+}
+
+// customHash(int32_t num)
+// PRE: 32 bit integer is passed
+// POST: 32 bits of hashed data yielded
+// WARNINGS: collisions may occur - collision resistance not tested
+// STATUS: Completed, tested.
+// Attribution: sourced from https://www.cs.ubc.ca/~rbridson/docs/schechter-sca08-turbulence.pdf
+uint32_t customHash(uint32_t num) {
+    num = num ^ 2747636419;
+    num = (num * 2654435769) % UINT32_MAX;
+    num = num ^ (num >> 16);
+    num = (num * 2654435769) % UINT32_MAX;
+    num = num ^ (num >> 16);
+    num = (num * 2654435769) % UINT32_MAX;
+    return num;
+}
+
+// iterativeHash(std::string key, uint32_t tarlen)
+// PRE: key pas sed as a string
+// POST: key padded to n bytes with deterministic pseudorandomness
+// WARNINGS: collisions may occur - collision resistance not tested
+// STATUS: Completed, tested.
+std::string iterativeHash(std::string key, uint32_t tarlen) {
+    uint32_t baseNum(0);
+    // this should fix the ordering issue
+    for (size_t i = 0; i < key.length(); ++i) {
+        baseNum += static_cast<uint32_t>(key[i]) * i;
+    }
+    // each appended byte depends on every byte before it, so baseNum is carried forward rather than recomputed
+    while (key.length() < tarlen) {
+        // hash basenum
+        uint32_t base = customHash(baseNum);
+        std::mt19937 gen(base); // seed the generator
+        std::uniform_int_distribution<> distr(32, 255);
+        char randomAppend = static_cast<char>(distr(gen));
+        baseNum += static_cast<uint32_t>(randomAppend) * key.length();
+        key += randomAppend;
+    }
+    return key;
+}
+
+// strXOR(std::string r, std::string k)
+// PRE: r, k are 4 char strings representing binary numbers
+// POST: result of r XOR k is returned.
+// WARNING: Different length inputs may yield bad results
+// STATUS: Completed, tested
+std::string strXOR(std::string r, std::string k) {
+    STATS_PHASE(PHASE_XOR);
+    STATS_BYTES(PHASE_XOR, r.length() / 8);
+    std::string retStr = "";
+    for (size_t i = 0; i < r.length(); i++) {
+        if (r[i] == '1' || k[i] == '1') {
+            if (r[i] == '1' && k[i] == '1') {
+                retStr.append("0");
+            }
+            else {
+                retStr.append("1");
+            }
+        }
+        else {
+            retStr.append("0");
+        }
+    }
+    return retStr;
+}
+
+// strToBin(std::string str)
+// PRE: A string is passed containing valid characters
+// POST: A bitstring of those characters is returned
+// WARNING: Invalid data types may be corrupted via this process.
+// STATUS: Completed, tested
+std::string strToBin(std::string str) {
+    STATS_PHASE(PHASE_STRTOBIN);
+    STATS_BYTES(PHASE_STRTOBIN, str.length());
+    std::string binStr = "";
+    for (uint32_t i = 0; i < str.length(); ++i) {
+        binStr.append(std::bitset<8>(str[i]).to_string());
+    }
+    return binStr;
+}
+
+// binToStr(std::string str)
+// PRE: A string of bits is passed
+// POST: A char converted string is returned
+// WARNING: Invalid data types may be corrupted via this process.
+// STATUS: Completed, tested
+std::string binToStr(std::string str) {
+    STATS_PHASE(PHASE_BINTOSTR);
+    STATS_BYTES(PHASE_BINTOSTR, str.length() / 8);
+    std::string retStr;
+    retStr.reserve(str.length() / 8);
+    // walk the bitstring in place; trimming the front each byte made this quadratic
+    for (size_t i = 0; i + 8 <= str.length(); i += 8) {
+        int num = 0;
+        for (size_t j = i; j < i + 8; ++j) {
+            num = (num << 1) | (str[j] == '1');
+        }
+        char myChar = static_cast<char>(num);
+        retStr += myChar;
+    }
+    return retStr;
+}
+
+// rsa(uint32_t p, uint32_t q, uint32_t seed)
+// PRE: User is encrypting asymmetrically
+// POST: valid RSA ciphertext returned
+// WARNINGS: Large quantities of p,q,seed may result in overflow
+// STATUS: Completed, tested
+uint32_t rsa(uint32_t p, uint32_t q, uint32_t seed) {
+    return rsa(p * q, seed);
+}
+
+// rsa(uint32_t n, uint32_t seed)
+// PRE: public modulus n and seed passed
+// POST: seed^17 mod n returned
+// WARNINGS: None
+// STATUS: Completed, tested
+uint32_t rsa(uint32_t n, uint32_t seed) {
+    uint32_t e = 17;
+
+    // square and multiply: 5 reductions for e = 17 rather than 17, which matters once n is not a compile-time constant
+    uint64_t ciphertext = 1;
+    uint64_t base = seed % n;
+    while (e != 0) {
+        if (e & 1) {
+            ciphertext = (ciphertext * base) % n;
+        }
+        base = (base * base) % n;
+        e >>= 1;
+    }
+
+    return ciphertext;
+}
+
+// constructTranslucentElement()
+// PRE: 1 is selected for encoding
+// POST: A set element is constructed per Canetti et. al. construction 2
+// WARNING: Time-based seeding produces vulnerabilities, should be quelled with BBS
 // Small p,q are easily breakable
 // STATUS: completed, tested
 std::string constructTranslucentElement() {
-    uint32_t t = 64;
-    uint32_t s = 32, k = 32; // P(0 dec as 1) = 1 / 2^32 apprx .000000000232, 2 bits/10 billion, approx 1 bitflip per 625 MB is E
     uint32_t p = 6827, q = 4079;
     // done to illustrate RSA functionality - in reality, public key is only predicate, e, n
     // In practicum, users should use p,q of cryptographic size (256/512 bits), along with a different seeding algorithm
     uint32_t seed = customHash(time(0));
     // original x0
     seed = blumblumshub(p, q, seed, 17)[time(0) % 17];
-    uint32_t randNum = seed;
-    std::vector<bool> predicates;
-    std::vector<bool> ciphertext;
+    return std::bitset<64>(translucentElement(p * q, seed)).to_string();
+}
 
+// translucentElement(uint32_t n, uint32_t seed)
+// PRE: public modulus n and an original x0 below n passed
+// POST: element per Canetti et. al. construction 2 returned packed: x0 after k - 1 rounds in the high 32 bits,
+//       the k predicates in the low 32, first round in the top bit
+// WARNING: A seed of 0 yields an element that cannot be inverted
+// STATUS: completed, tested
+uint64_t translucentElement(uint32_t n, uint32_t seed) {
+    uint32_t k = 32; // P(0 dec as 1) = 1 / 2^32 apprx .000000000232, 2 bits/10 billion, approx 1 bitflip per 625 MB is E
+    uint32_t randNum = seed;
+    uint32_t predicates = 0;
     for (uint32_t i = 0; i < k; ++i) {
         if (i != 0) {
-            randNum = rsa(p,q,randNum);
-        }
-        predicates.push_back(hcpredicate(randNum));
-    }
-    std::string x0 = std::bitset<32>(randNum).to_string();
-    std::string predicateStr;
-    for (uint32_t i = 0; i < k; ++i) {
-        if (predicates[i] == true) {
-            predicateStr += "1";
-        }
-        else {
-            predicateStr += "0";
+            randNum = rsa(n, randNum);
         }
+        predicates = (predicates << 1) | static_cast<uint32_t>(hcpredicate(randNum));
     }
-    std::string bitstring = x0 + predicateStr;
-    return bitstring;
+    STATS_COUNT(translucentElements, 1);
+    STATS_COUNT(rsaRounds, k - 1);
+    return (static_cast<uint64_t>(randNum) << 32) | predicates;
 }
 
 // randomAsymmElement()
@@ -662,23 +1657,77 @@ std::string randomAsymmElement() {
     strleft = newl;
     strright = newr;
     retstr = strleft + strright;
+    STATS_COUNT(randomElements, 1);
     return retstr;
 }
 
+// fillEntropyPool(size_t count)
+// PRE: number of words wanted passed: two per element to be generated per recipient
+// POST: count words from an mt19937 seeded by std::random_device returned
+// WARNINGS: Drawn once per batch and shared, so every recipient's stream is derived from the same words
+// STATUS: completed, tested
+std::vector<uint32_t> fillEntropyPool(size_t count) {
+    std::random_device rd;
+    std::seed_seq seq{ rd(), rd(), rd(), rd(), rd(), rd(), rd(), rd() };
+    std::mt19937 gen(seq);
+    std::vector<uint32_t> pool(count);
+    for (size_t i = 0; i < count; ++i) {
+        pool[i] = gen();
+    }
+    return pool;
+}
+
+// asymmEncodeBits(const std::string& bitstr, uint32_t n, const std::vector<uint32_t>& pool, uint32_t salt)
+// PRE: cleartext bitstring, recipient modulus, an entropy pool of two words per bit, and a secret per-recipient salt passed
+// POST: one 64 bit element per bit returned as raw characters, as asymmEncode() would lay them out. A 0 bit's two
+//       halves come from separate pool words so that neither can be computed from the other without the salt, and
+//       its high half is reduced into [1, n) like a 1 bit's x0, so the two cannot be told apart by range.
+// WARNINGS: Recipients must use distinct salts drawn from std::random_device, or their 0 bits will encode alike
+// STATUS: completed, tested
+std::string asymmEncodeBits(const std::string& bitstr, uint32_t n, const std::vector<uint32_t>& pool, uint32_t salt) {
+    STATS_PHASE(PHASE_ELEMENTS);
+    STATS_BYTES(PHASE_ELEMENTS, bitstr.length() / 8);
+    std::string ciphertext;
+    ciphertext.reserve(bitstr.length() * 8);
+    for (size_t i = 0; i < bitstr.length(); ++i) {
+        uint32_t high = customHash(pool[2 * i] ^ salt) % n;
+        high = high == 0 ? 1 : high;
+        uint64_t element;
+        if (bitstr[i] == '1') {
+            element = translucentElement(n, high);
+        }
+        else {
+            element = (static_cast<uint64_t>(high) << 32) | customHash(pool[2 * i + 1] ^ salt);
+            STATS_COUNT(randomElements, 1);
+        }
+        putBE32(ciphertext, static_cast<uint32_t>(element >> 32));
+        putBE32(ciphertext, static_cast<uint32_t>(element));
+    }
+    return ciphertext;
+}
+
+// elementsBelowModulus(const std::string& elements, uint32_t n)
+// PRE: raw elements as asymmEncodeBits() lays them out, and the modulus they were encoded for passed
+// POST: true returned if every element's high half is below n
+// WARNINGS: Only a 0 bit can have a high half at or above n, so any such element reveals its bit without the trapdoor
+// STATUS: Completed, tested
+bool elementsBelowModulus(const std::string& elements, uint32_t n) {
+    for (size_t off = 0; off + 8 <= elements.length(); off += 8) {
+        if (getBE32(elements, off) >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // bool hcpredicate(uint32_t number) {
 // PRE: a translucent set is selected for encoding/testing for decoding
 // POST: A parity bit is returned based on a bitstring length sum over GF2
 // WARNING: None
 // STATUS: completed, tested
 bool hcpredicate(uint32_t number) {
-    std::string num = std::bitset<32>(number).to_string();
-    int parity = 0;
-    for (size_t i = 0; i < num.length(); ++i) {
-        if (num[i] == '1') {
-            parity = (parity + 1) % 2;
-        }
-    }
-    return static_cast<bool>(parity);
+    // popcount rather than a walk over the bitstring: the per-digit branch mispredicts on every random x0
+    return (std::bitset<32>(number).count() % 2) != 0;
 }
 
 // blumblumshub(uint32_t p1, uint32_t p2, uint32_t seed, uint32_t iterations)
@@ -744,6 +1793,15 @@ bool isPrime(uint32_t num) {
 // WARNING: functions only as well as invertRSA, which may overflow depending on p,q
 // STATUS: Complete, tested
 bool isTranslucentElement(std::string bitstr, uint32_t p, uint32_t q) {
+    return isTranslucentElement(bitstr, makeTrapdoor(p, q));
+}
+
+// isTranslucentElement(std::string bitstr, const Trapdoor& td)
+// PRE: bitstring + precomputed trapdoor passed
+// POST: Boolean value returned if an element or not
+// WARNING: functions only as well as invertRSA, which may overflow depending on p,q
+// STATUS: Complete, tested
+bool isTranslucentElement(std::string bitstr, const Trapdoor& td) {
     std::string predicatesStr = bitstr.substr(32, 32);
     std::string x0 = bitstr.substr(0, 32);
     std::reverse(predicatesStr.begin(), predicatesStr.end());
@@ -758,26 +1816,30 @@ bool isTranslucentElement(std::string bitstr, uint32_t p, uint32_t q) {
     }
     long long int signedTmp = std::stoll(x0, 0, 2);
     uint32_t unsInt = static_cast<uint32_t>(signedTmp);
+    STATS_COUNT(membershipTests, 1);
     for (uint32_t i = 0; i < 32; ++i) {
         if (hcpredicate(unsInt) == predicates[i]) {
-            unsInt = invertRSA(unsInt, p, q);
+            STATS_COUNT(inversions, 1);
+            unsInt = invertRSA(unsInt, td);
             if (unsInt == 0) {
                 std::cout << "Error: Unable to invert x0." << std::endl;
             }
         }
         else {
+            STATS_EXIT_DEPTH(i);
             return false;
         }
     }
+    STATS_EXIT_DEPTH(32);
     return true;
 }
 
-// invertRSA(uint32_t prev, uint32_t p, uint32_t q)
-// PRE: x0 as an integer + trapdoor primes p,q passed
-// POST: deciphered value returned given args
-// WARNING: may overflow depending on p, q, seed
+// makeTrapdoor(uint32_t p, uint32_t q)
+// PRE: trapdoor primes p,q passed
+// POST: modulus n and private exponent d derived via extended Euclid, ready for repeated inversion
+// WARNING: may overflow depending on p, q
 // STATUS: Complete, tested
-uint32_t invertRSA(uint32_t prev, uint32_t p, uint32_t q) {
+Trapdoor makeTrapdoor(uint32_t p, uint32_t q) {
     uint32_t n = p * q;
     uint32_t phi = (p - 1) * (q - 1);
     uint32_t e = 17;
@@ -806,13 +1868,1511 @@ uint32_t invertRSA(uint32_t prev, uint32_t p, uint32_t q) {
     if (prevrow[5] < 0) {
         prevrow[5] = phi + prevrow[5];
     }
-    uint32_t d = static_cast<uint32_t>(prevrow[5]);
+    Trapdoor td;
+    td.p = p;
+    td.q = q;
+    td.n = n;
+    td.d = static_cast<uint32_t>(prevrow[5]);
+    return td;
+}
+
+// invertRSA(uint32_t prev, uint32_t p, uint32_t q)
+// PRE: x0 as an integer + trapdoor primes p,q passed
+// POST: deciphered value returned given args
+// WARNING: may overflow depending on p, q, seed. Rederives d on every call; prefer the Trapdoor overload in loops.
+// STATUS: Complete, tested
+uint32_t invertRSA(uint32_t prev, uint32_t p, uint32_t q) {
+    return invertRSA(prev, makeTrapdoor(p, q));
+}
+
+// invertRSA(uint32_t prev, const Trapdoor& td)
+// PRE: x0 as an integer + precomputed trapdoor passed
+// POST: deciphered value prev^d mod n returned
+// WARNING: may overflow depending on p, q, seed
+// STATUS: Complete, tested
+uint32_t invertRSA(uint32_t prev, const Trapdoor& td) {
+    // square and multiply: log2(d) rounds rather than d multiplications
     unsigned long long int inversion = 1;
-    for (uint32_t i = 0; i < d; ++i) {
-        inversion = (inversion * prev) % n;
-        if (inversion == 0) {
-            std::cout << "ERROR: INVERSION FOUND TO BE 0 AT ITERATION " << i << std::endl;
+    unsigned long long int base = prev % td.n;
+    uint32_t exp = td.d;
+    while (exp != 0) {
+        if (exp & 1) {
+            inversion = (inversion * base) % td.n;
         }
+        base = (base * base) % td.n;
+        exp >>= 1;
     }
-    return static_cast<uint32_t>(inversion);;
-}  
+    if (inversion == 0) {
+        std::cout << "ERROR: INVERSION FOUND TO BE 0" << std::endl;
+    }
+    return static_cast<uint32_t>(inversion);
+}
+
+const int64_t benchBatchNs = 100000; // a batch of ops is grown until it spans at least this long between clock reads
+
+// BenchResult
+// One measurement of a benchmarked operation at a given input size and thread count.
+// bytes is the input consumed by a single op, so MB/s and bits/s describe input throughput.
+struct BenchResult {
+    std::string name;
+    uint32_t bytes;
+    uint32_t threads;
+    uint64_t iterations;
+    double nsPerOp;
+    double mbPerSec;
+    double bitsPerSec;
+};
+
+// BenchCase
+// A benchmarked operation, the input sizes it is measured at, and the op itself.
+// The op receives a generated input of the requested size and returns a value folded into a sink.
+// prepare, when set, transforms the generated input once, outside of the timed region.
+struct BenchCase {
+    std::string name;
+    std::vector<uint32_t> sizes;
+    std::function<uint32_t(const std::string&)> op;
+    std::function<std::string(const std::string&)> prepare;
+};
+
+// benchInput(uint32_t seed, uint32_t len)
+// PRE: seed and desired length passed
+// POST: len bytes of printable pseudorandom text returned, identical for identical seeds
+// WARNINGS: None
+// STATUS: Completed, tested
+std::string benchInput(uint32_t seed, uint32_t len) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> distr(32, 126);
+    std::string retStr(len, '\0');
+    for (uint32_t i = 0; i < len; ++i) {
+        retStr[i] = static_cast<char>(distr(gen));
+    }
+    return retStr;
+}
+
+// runBench(const BenchCase& bc, uint32_t bytes, uint32_t threads, uint32_t seed, uint32_t minMillis)
+// PRE: case, input size, thread count, input seed and per-thread time budget passed
+// POST: every thread runs the op on its own input until the budget elapses (at least once); aggregate result returned
+// WARNINGS: ns/op is per-thread latency, MB/s and bits/s are aggregate across threads
+// STATUS: Completed, tested
+BenchResult runBench(const BenchCase& bc, uint32_t bytes, uint32_t threads, uint32_t seed, uint32_t minMillis) {
+    std::vector<std::string> inputs;
+    for (uint32_t t = 0; t < threads; ++t) {
+        std::string input = benchInput(seed + t, bytes);
+        inputs.push_back(bc.prepare ? bc.prepare(input) : input);
+    }
+    std::vector<uint64_t> counts(threads, 0);
+    std::atomic<uint32_t> sink(0);
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(minMillis);
+    std::vector<std::thread> pool;
+    for (uint32_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            uint32_t local = 0;
+            uint64_t n = 0, batch = 1;
+            // ops run in batches between clock reads, doubling until a batch spans benchBatchNs, so reading
+            // the clock does not swamp nanosecond-scale ops
+            while (1) {
+                auto batchStart = std::chrono::steady_clock::now();
+                for (uint64_t i = 0; i < batch; ++i) {
+                    local ^= bc.op(inputs[t]);
+                }
+                n += batch;
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    break;
+                }
+                if (std::chrono::duration_cast<std::chrono::nanoseconds>(now - batchStart).count() < benchBatchNs) {
+                    batch *= 2;
+                }
+            }
+            counts[t] = n;
+            sink ^= local;
+        });
+    }
+    for (size_t t = 0; t < pool.size(); ++t) {
+        pool[t].join();
+    }
+    double elapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    BenchResult res;
+    res.name = bc.name;
+    res.bytes = bytes;
+    res.threads = threads;
+    res.iterations = 0;
+    for (uint32_t t = 0; t < threads; ++t) {
+        res.iterations += counts[t];
+    }
+    res.nsPerOp = elapsedNs * threads / static_cast<double>(res.iterations);
+    double bytesPerSec = static_cast<double>(res.iterations) * bytes / (elapsedNs / 1e9);
+    res.mbPerSec = bytesPerSec / 1e6;
+    res.bitsPerSec = bytesPerSec * 8;
+    return res;
+}
+
+// benchToJSON(const std::vector<BenchResult>& results, uint32_t seed)
+// PRE: completed measurements passed
+// POST: JSON document with one object per measurement returned
+// WARNINGS: names are emitted unescaped, keep them to plain identifiers
+// STATUS: Completed, tested
+std::string benchToJSON(const std::vector<BenchResult>& results, uint32_t seed) {
+    std::ostringstream json;
+    json << "{\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        json << "    {\"name\": \"" << r.name << "\", \"bytes\": " << r.bytes << ", \"threads\": " << r.threads
+             << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << std::fixed << std::setprecision(2) << r.nsPerOp
+             << ", \"mb_per_s\": " << r.mbPerSec << ", \"bits_per_s\": " << std::setprecision(0) << r.bitsPerSec << "}";
+        json << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+// benchField(const std::string& obj, const std::string& field)
+// PRE: a single JSON object as written by benchToJSON and a field name passed
+// POST: the raw text of that field's value returned, or an empty string if absent
+// WARNINGS: Only understands the flat format benchToJSON emits
+// STATUS: Completed, tested
+std::string benchField(const std::string& obj, const std::string& field) {
+    size_t pos = obj.find("\"" + field + "\":");
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += field.length() + 3;
+    while (pos < obj.length() && (obj[pos] == ' ' || obj[pos] == '"')) {
+        ++pos;
+    }
+    size_t end = obj.find_first_of(",\"}", pos);
+    return obj.substr(pos, end - pos);
+}
+
+// compareBaseline(const std::vector<BenchResult>& results, std::string path, double tolerance, uint32_t& regressions)
+// PRE: completed measurements, path to a JSON file previously written by --json, and an allowed slowdown fraction passed
+// POST: regressions beyond tolerance are reported and counted in regressions; false returned if the baseline is
+//       unreadable, or a matching measurement's ns_per_op is not a number
+// WARNINGS: measurements absent from the baseline are skipped
+// STATUS: Completed, tested
+bool compareBaseline(const std::vector<BenchResult>& results, std::string path, double tolerance, uint32_t& regressions) {
+    regressions = 0;
+    std::ifstream rawBase(path.c_str());
+    if (!rawBase.good()) {
+        std::cout << "Error: Unable to read baseline " << path << "." << std::endl;
+        return false;
+    }
+    std::string line;
+    std::vector<std::string> objects;
+    while (std::getline(rawBase, line)) {
+        if (line.find("\"name\":") != std::string::npos) {
+            objects.push_back(line);
+        }
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        for (size_t j = 0; j < objects.size(); ++j) {
+            if (benchField(objects[j], "name") != r.name
+                || benchField(objects[j], "bytes") != std::to_string(r.bytes)
+                || benchField(objects[j], "threads") != std::to_string(r.threads)) {
+                continue;
+            }
+            double base;
+            try {
+                base = std::stod(benchField(objects[j], "ns_per_op"));
+            }
+            catch (const std::exception&) {
+                std::cout << "Error: Malformed ns_per_op for " << r.name << " in baseline " << path << "." << std::endl;
+                return false;
+            }
+            if (r.nsPerOp > base * (1.0 + tolerance)) {
+                std::cout << "REGRESSION: " << r.name << " bytes=" << r.bytes << " threads=" << r.threads << ": "
+                          << std::fixed << std::setprecision(2) << base << " -> " << r.nsPerOp << " ns/op" << std::endl;
+                ++regressions;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+// benchmark(int argc, char* argv[])
+// PRE: --bench passed on the command line, optionally with
+//      --seed N (fixed input seed), --time MS (per-measurement budget), --threads N (scaling ceiling),
+//      --filter STR (substring of case names), --json PATH, --baseline PATH, --tolerance PCT
+// POST: hot paths measured, table printed, JSON written/compared as requested; nonzero return on regression
+// WARNINGS: Element construction seeds from time(0) internally, so only the inputs are deterministic.
+// STATUS: Completed, tested
+int benchmark(int argc, char* argv[]) {
+    uint32_t p = 6827, q = 4079;
+    uint32_t seed = static_cast<uint32_t>(time(0));
+    uint32_t minMillis = 200;
+    uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double tolerance = 0.10;
+    std::string filter, jsonPath, basePath;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cout << "Error: " << arg << " expects a value." << std::endl;
+            return 1;
+        }
+        std::string val = argv[++i];
+        try {
+            if (arg == "--seed") {
+                seed = static_cast<uint32_t>(std::stoul(val));
+            }
+            else if (arg == "--time") {
+                minMillis = static_cast<uint32_t>(std::stoul(val));
+            }
+            else if (arg == "--threads") {
+                maxThreads = std::max(1u, static_cast<uint32_t>(std::stoul(val)));
+            }
+            else if (arg == "--filter") {
+                filter = val;
+            }
+            else if (arg == "--json") {
+                jsonPath = val;
+            }
+            else if (arg == "--baseline") {
+                basePath = val;
+            }
+            else if (arg == "--tolerance") {
+                tolerance = std::stod(val) / 100.0;
+            }
+            else {
+                std::cout << "Error: Unknown benchmark option " << arg << "." << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception&) {
+            std::cout << "Error: " << arg << " expects a number, not " << val << "." << std::endl;
+            return 1;
+        }
+    }
+    // scalar inputs are drawn from the first four input bytes, kept below n so the trapdoor applies
+    auto word = [](const std::string& in) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(in[0])) << 24) | (static_cast<uint32_t>(static_cast<unsigned char>(in[1])) << 16)
+             | (static_cast<uint32_t>(static_cast<unsigned char>(in[2])) << 8) | static_cast<uint32_t>(static_cast<unsigned char>(in[3]));
+    };
+    std::string element = constructTranslucentElement();
+    Trapdoor trapdoor = makeTrapdoor(p, q);
+    std::vector<BenchCase> cases = {
+        { "strXOR", { 64, 1024, 16384 }, [](const std::string& in) {
+            std::string bits = strToBin(in);
+            return static_cast<uint32_t>(strXOR(bits, bits).length()); }, nullptr },
+        { "strToBin", { 64, 1024, 16384 }, [](const std::string& in) {
+            return static_cast<uint32_t>(strToBin(in).length()); }, nullptr },
+        { "binToStr", { 64, 1024, 16384 }, [](const std::string& in) {
+            return static_cast<uint32_t>(binToStr(std::string(in.length() * 8, '1')).length()); }, nullptr },
+        { "iterativeHash", { 64, 1024, 16384 }, [](const std::string& in) {
+            return static_cast<uint32_t>(iterativeHash(in.substr(0, 16), in.length()).length()); }, nullptr },
+        { "customHash", { 4 }, [&](const std::string& in) {
+            return customHash(word(in)); }, nullptr },
+        { "rsa", { 4 }, [&](const std::string& in) {
+            return rsa(p, q, word(in) % (p * q)); }, nullptr },
+        { "invertRSA", { 4 }, [&](const std::string& in) {
+            return invertRSA(word(in) % (p * q), trapdoor); }, nullptr },
+        { "makeTrapdoor", { 4 }, [&](const std::string& in) {
+            return makeTrapdoor(p, q).d ^ word(in); }, nullptr },
+        { "hcpredicate", { 4 }, [&](const std::string& in) {
+            return static_cast<uint32_t>(hcpredicate(word(in))); }, nullptr },
+        { "blumblumshub", { 4 }, [&](const std::string& in) {
+            return static_cast<uint32_t>(blumblumshub(p, q, word(in), 17).size()); }, nullptr },
+        { "constructTranslucentElement", { 8 }, [](const std::string&) {
+            return static_cast<uint32_t>(constructTranslucentElement().length()); }, nullptr },
+        { "isTranslucentElement", { 8 }, [&](const std::string&) {
+            return static_cast<uint32_t>(isTranslucentElement(element, trapdoor)); }, nullptr },
+        { "symmEncrypt", { 64, 1024, 16384 }, [](const std::string& in) {
+            return static_cast<uint32_t>(symmXOR(in, fitSymmKey(in.substr(0, 16), in.length())).length()); }, nullptr },
+        { "symmDecrypt", { 64, 1024, 16384 }, [](const std::string& in) {
+            return static_cast<uint32_t>(symmXOR(in, in).length()); }, nullptr },
+        { "lzCompress", { 1024, 16384, 262144 }, [](const std::string& in) {
+            return static_cast<uint32_t>(lzCompress(in).length()); }, nullptr },
+        { "lzDecompress", { 1024, 16384, 262144 }, [](const std::string& in) {
+            std::string out;
+            return static_cast<uint32_t>(lzDecompress(in, out)); }, lzCompress },
+        { "expandSessionKey", { 1024, 16384, 262144 }, [](const std::string& in) {
+            return static_cast<uint32_t>(expandSessionKey(in.substr(0, hybridKeyLen), static_cast<uint32_t>(in.length())).length()); }, nullptr },
+        { "hybridEncrypt", { 1024, 16384, 262144 }, [](const std::string& in) {
+            return static_cast<uint32_t>(asymmSeal(in, ASYMM_FLAG_HYBRID).length()); }, nullptr },
+        { "hybridDecrypt", { 1024, 16384, 262144 }, [&](const std::string& in) {
+            std::string out;
+            return static_cast<uint32_t>(asymmOpen(in, trapdoor, out)); }, [](const std::string& in) { return asymmSeal(in, ASYMM_FLAG_HYBRID); } },
+        { "asymmEncrypt", { 1, 16, 64 }, [](const std::string& in) {
+            return static_cast<uint32_t>(asymmEncode(in).length()); }, nullptr },
+        { "asymmDecrypt", { 1, 16, 64 }, [&](const std::string& in) {
+            return static_cast<uint32_t>(asymmDecode(in, trapdoor).length()); }, asymmEncode },
+        { "recipientEncode", { 1, 16, 64 }, [&](const std::string& in) {
+            std::string bitstr = strToBin(in);
+            return static_cast<uint32_t>(asymmEncodeBits(bitstr, trapdoor.n, fillEntropyPool(bitstr.length() * 2), 1).length()); }, nullptr },
+    };
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::vector<BenchResult> results;
+    std::cout << "ROXy benchmark: seed " << seed << ", " << minMillis << " ms/measurement, up to " << maxThreads << " threads" << std::endl;
+    std::cout << "********************************************************" << std::endl;
+    std::cout << std::left << std::setw(30) << "case" << std::right << std::setw(8) << "bytes" << std::setw(8) << "threads"
+              << std::setw(16) << "ns/op" << std::setw(12) << "MB/s" << std::setw(16) << "bits/s" << std::endl;
+    for (size_t c = 0; c < cases.size(); ++c) {
+        if (!filter.empty() && cases[c].name.find(filter) == std::string::npos) {
+            continue;
+        }
+        // size sweep single threaded, then a thread scaling curve at the largest size
+        std::vector<std::pair<uint32_t, uint32_t>> runs;
+        for (size_t s = 0; s < cases[c].sizes.size(); ++s) {
+            runs.push_back(std::make_pair(cases[c].sizes[s], 1u));
+        }
+        for (size_t t = 0; t < threadCounts.size(); ++t) {
+            if (threadCounts[t] != 1) {
+                runs.push_back(std::make_pair(cases[c].sizes.back(), threadCounts[t]));
+            }
+        }
+        for (size_t r = 0; r < runs.size(); ++r) {
+            BenchResult res = runBench(cases[c], runs[r].first, runs[r].second, seed, minMillis);
+            results.push_back(res);
+            std::cout << std::left << std::setw(30) << res.name << std::right << std::setw(8) << res.bytes << std::setw(8) << res.threads
+                      << std::fixed << std::setprecision(1) << std::setw(16) << res.nsPerOp << std::setprecision(3) << std::setw(12) << res.mbPerSec
+                      << std::setprecision(0) << std::setw(16) << res.bitsPerSec << std::endl;
+        }
+    }
+    std::cout << "********************************************************" << std::endl;
+    if (!jsonPath.empty()) {
+        std::ofstream jsonOut(jsonPath.c_str());
+        jsonOut << benchToJSON(results, seed);
+        jsonOut.close();
+        std::cout << "Results written to: " << jsonPath << std::endl;
+    }
+    if (!basePath.empty()) {
+        uint32_t regressions;
+        if (!compareBaseline(results, basePath, tolerance, regressions)) {
+            return 1;
+        }
+        if (regressions != 0) {
+            std::cout << regressions << " regression(s) beyond " << tolerance * 100 << "% of baseline." << std::endl;
+            return 1;
+        }
+        std::cout << "No regressions beyond " << tolerance * 100 << "% of baseline." << std::endl;
+    }
+    return 0;
+}
+
+// Daemon mode
+// roxy --daemon SOCKET [--key KEYFILE] [--workers N] loads the symmetric key and the asymmetric trapdoor once and
+// serves requests over a Unix domain socket; roxy --client is a minimal client for it. Frames start with an
+// 8 byte header, integers big-endian:
+//   request:  op (1) | flags (1) | reserved (2) | payload length (4) | payload
+//   response: status (1) | reserved (3) | payload length (4) | payload (the result, or an error message)
+// A poll() event loop accepts and reads; each complete request goes to a worker pool which writes the response.
+// A connection is not read from while its request is in flight, so responses come back in request order.
+enum DaemonOp { OP_SYMM_ENCRYPT = 1, OP_SYMM_DECRYPT = 2, OP_ASYMM_ENCRYPT = 3, OP_ASYMM_DECRYPT = 4 };
+enum DaemonStatus { STATUS_OK = 0, STATUS_ERROR = 1 };
+const uint8_t DAEMON_FLAG_COMPRESS = 0x01; // asymm-encrypt: compress before encoding
+const uint8_t DAEMON_FLAG_HYBRID = 0x02; // asymm-encrypt: encode a session key, XOR the payload with its key stream
+const uint32_t daemonHeaderLen = 8;
+const uint32_t daemonMaxPayload = 16 * 1024 * 1024;
+const uint32_t daemonMaxElementPayload = 64 * 1024; // asymm-encrypt without hybrid: 512 bitstring chars per byte in flight
+const uint32_t daemonMaxElementCiphertext = daemonMaxElementPayload * 64; // asymm-decrypt without hybrid: the same element count
+const uint32_t daemonWarmKeyLen = 64 * 1024;
+
+#if defined(__unix__) || defined(__APPLE__)
+volatile sig_atomic_t daemonStop = 0;
+
+// DaemonState
+// Key material prepared once at startup and shared by every worker.
+// The expanded symmetric key only ever grows, since iterativeHash output for n bytes is a prefix of that for m > n.
+struct DaemonState {
+    bool haveSymmKey = false;
+    std::string symmKey;
+    std::mutex symmKeyLock;
+    Trapdoor trapdoor;
+};
+
+// DaemonJob
+// One complete request, handed from the event loop to a worker.
+struct DaemonJob {
+    int fd;
+    uint8_t op;
+    uint8_t flags;
+    std::string payload;
+};
+
+// DaemonQueue
+// Requests waiting for a worker, and connections whose response has been written and may be read from again.
+// Workers signal the latter by writing a byte to wakeFd, which the event loop polls.
+struct DaemonQueue {
+    std::mutex lock;
+    std::condition_variable ready;
+    std::queue<DaemonJob> jobs;
+    std::queue<int> done;
+    bool stopping = false;
+    int wakeFd = -1;
+};
+
+// DaemonConn
+// Event loop view of a client: bytes read but not yet dispatched, and whether a request is in flight.
+struct DaemonConn {
+    std::string inbuf;
+    bool busy = false;
+};
+
+// daemonFrame(uint8_t first, uint8_t second, const std::string& payload)
+// PRE: op/status byte, flags byte and payload passed
+// POST: complete frame returned, header followed by payload
+// WARNINGS: None
+// STATUS: Completed, tested
+std::string daemonFrame(uint8_t first, uint8_t second, const std::string& payload) {
+    std::string frame;
+    frame += static_cast<char>(first);
+    frame += static_cast<char>(second);
+    frame += std::string(2, '\0');
+    putBE32(frame, static_cast<uint32_t>(payload.length()));
+    return frame + payload;
+}
+
+// sendAll(int fd, const std::string& data)
+// PRE: connected socket and data passed
+// POST: all of data written, returning false if the peer went away
+// WARNINGS: Blocks until written
+// STATUS: Completed, tested
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.length()) {
+        ssize_t n = send(fd, data.data() + sent, data.length() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// recvAll(int fd, std::string& data, size_t len)
+// PRE: connected socket passed
+// POST: exactly len bytes read into data, returning false on EOF or error
+// WARNINGS: Blocks until read
+// STATUS: Completed, tested
+bool recvAll(int fd, std::string& data, size_t len) {
+    data.assign(len, '\0');
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = recv(fd, &data[got], len - got, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// daemonSymmKey(DaemonState& state, uint32_t len)
+// PRE: symmetric key loaded
+// POST: the key fitted to len bytes returned, identical to fitSymmKey(key, len)
+// WARNINGS: Extends the shared expansion under a lock the first time a longer payload arrives
+// STATUS: Completed, tested
+std::string daemonSymmKey(DaemonState& state, uint32_t len) {
+    std::lock_guard<std::mutex> guard(state.symmKeyLock);
+    if (state.symmKey.length() < len) {
+        state.symmKey = fitSymmKey(state.symmKey, len);
+    }
+    return state.symmKey.substr(0, len);
+}
+
+// daemonHandle(DaemonState& state, const DaemonJob& job, std::string& result)
+// PRE: a complete request passed
+// POST: result holds the transformed payload on STATUS_OK, or an error message otherwise
+// WARNINGS: None
+// STATUS: Completed, tested
+uint8_t daemonHandle(DaemonState& state, const DaemonJob& job, std::string& result) {
+    switch (job.op) {
+    case OP_SYMM_ENCRYPT:
+    case OP_SYMM_DECRYPT:
+        if (!state.haveSymmKey) {
+            result = "No symmetric key loaded; start the daemon with --key.";
+            return STATUS_ERROR;
+        }
+        result = symmXOR(job.payload, daemonSymmKey(state, static_cast<uint32_t>(job.payload.length())));
+        return STATUS_OK;
+    case OP_ASYMM_ENCRYPT:
+        result = asymmSeal(job.payload, ((job.flags & DAEMON_FLAG_COMPRESS) ? ASYMM_FLAG_COMPRESSED : 0)
+                                        | ((job.flags & DAEMON_FLAG_HYBRID) ? ASYMM_FLAG_HYBRID : 0));
+        return STATUS_OK;
+    case OP_ASYMM_DECRYPT:
+        if (job.payload.length() >= asymmHeaderLen && job.payload.compare(0, 4, asymmMagic) == 0
+            && (static_cast<uint8_t>(job.payload[5]) & ASYMM_FLAG_RECIPIENT)) {
+            result = "Ciphertext was encrypted for a recipient key; decrypt it interactively with that recipient's private key.";
+            return STATUS_ERROR;
+        }
+        if (!asymmOpen(job.payload, state.trapdoor, result)) {
+            result = "Failed to restore cleartext; the ciphertext may be corrupted.";
+            return STATUS_ERROR;
+        }
+        return STATUS_OK;
+    default:
+        result = "Unknown op " + std::to_string(job.op) + ".";
+        return STATUS_ERROR;
+    }
+}
+
+// daemonWorker(DaemonState& state, DaemonQueue& queue)
+// PRE: daemon started
+// POST: requests are taken from the queue, answered, and their connections handed back until the daemon stops
+// WARNINGS: None
+// STATUS: Completed, tested
+void daemonWorker(DaemonState& state, DaemonQueue& queue) {
+    while (1) {
+        DaemonJob job;
+        {
+            std::unique_lock<std::mutex> guard(queue.lock);
+            queue.ready.wait(guard, [&]() { return queue.stopping || !queue.jobs.empty(); });
+            if (queue.jobs.empty()) {
+                return;
+            }
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop();
+        }
+        std::string result;
+        uint8_t status = daemonHandle(state, job, result);
+        sendAll(job.fd, daemonFrame(status, 0, result));
+        {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.done.push(job.fd);
+        }
+        char wake = 1;
+        while (write(queue.wakeFd, &wake, 1) < 0 && errno == EINTR) {
+        }
+    }
+}
+
+// daemonDispatch(int fd, DaemonConn& conn, DaemonQueue& queue)
+// PRE: bytes have arrived on, or a response has been written to, connection fd
+// POST: if the connection is idle and a complete request is buffered, it is queued for a worker.
+//       Returns false if the buffered request is oversized and the connection should be dropped.
+// WARNINGS: None
+// STATUS: Completed, tested
+bool daemonDispatch(int fd, DaemonConn& conn, DaemonQueue& queue) {
+    if (conn.busy || conn.inbuf.length() < daemonHeaderLen) {
+        return true;
+    }
+    uint32_t len = getBE32(conn.inbuf, 4);
+    if (len > daemonMaxPayload) {
+        sendAll(fd, daemonFrame(STATUS_ERROR, 0, "Payload exceeds " + std::to_string(daemonMaxPayload) + " bytes."));
+        return false;
+    }
+    if (static_cast<uint8_t>(conn.inbuf[0]) == OP_ASYMM_ENCRYPT && !(static_cast<uint8_t>(conn.inbuf[1]) & DAEMON_FLAG_HYBRID) && len > daemonMaxElementPayload) {
+        sendAll(fd, daemonFrame(STATUS_ERROR, 0, "Payloads over " + std::to_string(daemonMaxElementPayload) + " bytes must be encrypted in hybrid mode."));
+        return false;
+    }
+    if (static_cast<uint8_t>(conn.inbuf[0]) == OP_ASYMM_DECRYPT && len > daemonMaxElementCiphertext) {
+        // only a hybrid ciphertext bounds the decoding work, so wait for its header before deciding
+        if (conn.inbuf.length() < daemonHeaderLen + asymmHeaderLen) {
+            return true;
+        }
+        bool hybrid = conn.inbuf.compare(daemonHeaderLen, 4, asymmMagic) == 0
+                   && (static_cast<uint8_t>(conn.inbuf[daemonHeaderLen + 5]) & ASYMM_FLAG_HYBRID);
+        if (!hybrid) {
+            sendAll(fd, daemonFrame(STATUS_ERROR, 0, "Ciphertexts over " + std::to_string(daemonMaxElementCiphertext) + " bytes must be hybrid."));
+            return false;
+        }
+    }
+    if (conn.inbuf.length() < daemonHeaderLen + len) {
+        return true;
+    }
+    DaemonJob job;
+    job.fd = fd;
+    job.op = static_cast<uint8_t>(conn.inbuf[0]);
+    job.flags = static_cast<uint8_t>(conn.inbuf[1]);
+    job.payload = conn.inbuf.substr(daemonHeaderLen, len);
+    conn.inbuf.erase(0, daemonHeaderLen + len);
+    conn.busy = true;
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.jobs.push(std::move(job));
+    }
+    queue.ready.notify_one();
+    return true;
+}
+
+// daemonSignal(int sig)
+// PRE: SIGINT or SIGTERM received
+// POST: the event loop is asked to stop
+// WARNINGS: None
+// STATUS: Completed, tested
+void daemonSignal(int) {
+    daemonStop = 1;
+}
+
+// runDaemon(int argc, char* argv[])
+// PRE: --daemon SOCKET passed, optionally with --key KEYFILE and --workers N
+// POST: requests served until SIGINT/SIGTERM, then the socket is removed
+// WARNINGS: A socket left at SOCKET by an earlier run is removed; any other file there stops the daemon from starting
+// STATUS: Completed, tested
+int runDaemon(int argc, char* argv[]) {
+    uint32_t p = 6827, q = 4079;
+    if (argc < 3) {
+        std::cout << "Usage: roxy --daemon SOCKET [--key KEYFILE] [--workers N]" << std::endl;
+        return 1;
+    }
+    std::string socketPath = argv[2], keyPath;
+    uint32_t workers = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 3; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cout << "Error: " << arg << " expects a value." << std::endl;
+            std::cout << "Usage: roxy --daemon SOCKET [--key KEYFILE] [--workers N]" << std::endl;
+            return 1;
+        }
+        if (arg == "--key") {
+            keyPath = argv[i + 1];
+        }
+        else if (arg == "--workers") {
+            try {
+                workers = std::max(1u, static_cast<uint32_t>(std::stoul(argv[i + 1])));
+            }
+            catch (const std::exception&) {
+                std::cout << "Error: --workers expects a number, not " << argv[i + 1] << "." << std::endl;
+                return 1;
+            }
+        }
+        else {
+            std::cout << "Error: Unknown daemon option " << arg << "." << std::endl;
+            return 1;
+        }
+    }
+    DaemonState state;
+    if (!keyPath.empty()) {
+        std::ifstream rawKey(keyPath.c_str());
+        if (!rawKey.good()) {
+            std::cout << "Failed to open key file." << std::endl;
+            return 1;
+        }
+        std::ostringstream keyBuf;
+        keyBuf << rawKey.rdbuf();
+        state.symmKey = keyBuf.str();
+        if (state.symmKey.empty()) {
+            std::cout << "Key file is empty." << std::endl;
+            return 1;
+        }
+        state.haveSymmKey = true;
+        daemonSymmKey(state, daemonWarmKeyLen);
+    }
+    state.trapdoor = makeTrapdoor(p, q);
+    if (blumblumshub(p, q, customHash(static_cast<uint32_t>(time(0))), 1).empty()) {
+        std::cout << "Error: Trapdoor primes are unusable for BBS seeding." << std::endl;
+        return 1;
+    }
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.length() >= sizeof(addr.sun_path)) {
+        std::cout << "Error: Socket path too long." << std::endl;
+        return 1;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    // only a leftover socket is cleared; anything else at the path is left alone
+    struct stat existing;
+    if (lstat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cout << "Error: " << socketPath << " exists and is not a socket." << std::endl;
+            return 1;
+        }
+        unlink(socketPath.c_str());
+    }
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listenFd, 128) < 0) {
+        std::cout << "Error: Unable to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    int wakePipe[2];
+    if (pipe(wakePipe) < 0) {
+        std::cout << "Error: Unable to create wake pipe." << std::endl;
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, daemonSignal);
+    std::signal(SIGTERM, daemonSignal);
+
+    DaemonQueue queue;
+    queue.wakeFd = wakePipe[1];
+    std::vector<std::thread> pool;
+    for (uint32_t i = 0; i < workers; ++i) {
+        pool.emplace_back(daemonWorker, std::ref(state), std::ref(queue));
+    }
+    std::cout << "ROXy daemon listening on " << socketPath << " with " << workers << " workers." << std::endl;
+
+    std::map<int, DaemonConn> conns;
+    std::vector<pollfd> fds;
+    while (!daemonStop) {
+        fds.clear();
+        fds.push_back({ listenFd, POLLIN, 0 });
+        fds.push_back({ wakePipe[0], POLLIN, 0 });
+        for (auto it = conns.begin(); it != conns.end(); ++it) {
+            if (!it->second.busy) {
+                fds.push_back({ it->first, POLLIN, 0 });
+            }
+        }
+        if (poll(fds.data(), fds.size(), 1000) <= 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            ssize_t ignored = read(wakePipe[0], drain, sizeof(drain));
+            (void)ignored;
+            std::vector<int> finished;
+            {
+                std::lock_guard<std::mutex> guard(queue.lock);
+                while (!queue.done.empty()) {
+                    finished.push_back(queue.done.front());
+                    queue.done.pop();
+                }
+            }
+            for (size_t i = 0; i < finished.size(); ++i) {
+                DaemonConn& conn = conns[finished[i]];
+                conn.busy = false;
+                if (!daemonDispatch(finished[i], conn, queue)) {
+                    close(finished[i]);
+                    conns.erase(finished[i]);
+                }
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            int clientFd = accept(listenFd, nullptr, nullptr);
+            if (clientFd >= 0) {
+                conns[clientFd] = DaemonConn();
+            }
+        }
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            int fd = fds[i].fd;
+            char buf[65536];
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n <= 0) {
+                close(fd);
+                conns.erase(fd);
+                continue;
+            }
+            conns[fd].inbuf.append(buf, static_cast<size_t>(n));
+            if (!daemonDispatch(fd, conns[fd], queue)) {
+                close(fd);
+                conns.erase(fd);
+            }
+        }
+    }
+
+    std::cout << "Stopping ROXy daemon..." << std::endl;
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.stopping = true;
+    }
+    queue.ready.notify_all();
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i].join();
+    }
+    for (auto it = conns.begin(); it != conns.end(); ++it) {
+        close(it->first);
+    }
+    close(listenFd);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    unlink(socketPath.c_str());
+    return 0;
+}
+
+// runClient(int argc, char* argv[])
+// PRE: --client SOCKET OP INFILE OUTFILE [--compress] [--hybrid] passed, OP one of symm-encrypt, symm-decrypt, asymm-encrypt, asymm-decrypt
+// POST: INFILE sent to the daemon and the result written to OUTFILE; round trip time reported
+// WARNINGS: None
+// STATUS: Completed, tested
+int runClient(int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cout << "Usage: roxy --client SOCKET symm-encrypt|symm-decrypt|asymm-encrypt|asymm-decrypt INFILE OUTFILE [--compress] [--hybrid]" << std::endl;
+        return 1;
+    }
+    std::string socketPath = argv[2], opName = argv[3], inPath = argv[4], outPath = argv[5];
+    uint8_t op = 0, flags = 0;
+    for (int i = 6; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compress") {
+            flags |= DAEMON_FLAG_COMPRESS;
+        }
+        else if (arg == "--hybrid") {
+            flags |= DAEMON_FLAG_HYBRID;
+        }
+        else {
+            std::cout << "Error: Unknown client option " << arg << "." << std::endl;
+            return 1;
+        }
+    }
+    if (opName == "symm-encrypt") {
+        op = OP_SYMM_ENCRYPT;
+    }
+    else if (opName == "symm-decrypt") {
+        op = OP_SYMM_DECRYPT;
+    }
+    else if (opName == "asymm-encrypt") {
+        op = OP_ASYMM_ENCRYPT;
+    }
+    else if (opName == "asymm-decrypt") {
+        op = OP_ASYMM_DECRYPT;
+    }
+    else {
+        std::cout << "Error: Unknown op " << opName << "." << std::endl;
+        return 1;
+    }
+    std::ifstream rawFile(inPath.c_str(), std::ios::binary);
+    if (!rawFile.good()) {
+        std::cout << "Failed to open " << inPath << "." << std::endl;
+        return 1;
+    }
+    std::ostringstream inBuf;
+    inBuf << rawFile.rdbuf();
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cout << "Error: Unable to connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::string header, result;
+    // a request rejected early is answered before it is fully sent, so a response is read even if sending failed
+    bool sent = sendAll(fd, daemonFrame(op, flags, inBuf.str()));
+    if (!recvAll(fd, header, daemonHeaderLen) || !recvAll(fd, result, getBE32(header, 4)) || (!sent && header[0] == STATUS_OK)) {
+        std::cout << "Error: Connection to daemon lost." << std::endl;
+        close(fd);
+        return 1;
+    }
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    close(fd);
+    if (header[0] != STATUS_OK) {
+        std::cout << "Daemon error: " << result << std::endl;
+        return 1;
+    }
+    std::ofstream outFile(outPath.c_str(), std::ios::binary);
+    outFile << result;
+    outFile.close();
+    std::cout << "Wrote " << result.length() << " bytes to " << outPath << " in " << micros << " us." << std::endl;
+    return 0;
+}
+#else
+int runDaemon(int, char*[]) {
+    std::cout << "Daemon mode requires Unix domain sockets, which this platform does not provide." << std::endl;
+    return 1;
+}
+
+int runClient(int, char*[]) {
+    std::cout << "Daemon mode requires Unix domain sockets, which this platform does not provide." << std::endl;
+    return 1;
+}
+#endif
+
+// Asynchronous I/O
+// runPipeline() streams a file, or an in-memory buffer, through a transform and into an output file, keeping
+// several large reads and writes in flight so that disk and CPU work overlap. Chunks are transformed strictly in
+// order on the calling thread, with at most pipelineDepth chunks read ahead and pipelineDepth writes outstanding
+// (triple buffering). On Linux the requests go through io_uring; where io_uring is unavailable, or with --io-threads,
+// a pair of threads performs them with pread/pwrite. Other platforms read, transform and write synchronously.
+const uint32_t pipelineDepth = 3;
+const uint32_t pipelineAlign = 4096;
+
+#if defined(__unix__) || defined(__APPLE__)
+// AsyncIO
+// Positional reads and writes submitted without blocking, and reaped one completion at a time.
+// tag identifies the request; result is the byte count, or a negative errno.
+struct AsyncIO {
+    virtual ~AsyncIO() {}
+    virtual bool submit(bool isWrite, int fd, char* buf, uint32_t len, uint64_t off, uint64_t tag) = 0;
+    virtual bool wait(uint64_t& tag, int64_t& result) = 0;
+};
+
+// ThreadIO
+// Fallback backend: worker threads block in pread/pwrite on behalf of the submitter.
+struct ThreadIO : AsyncIO {
+    struct Request {
+        bool isWrite;
+        int fd;
+        char* buf;
+        uint32_t len;
+        uint64_t off;
+        uint64_t tag;
+    };
+    std::mutex lock;
+    std::condition_variable requestReady, completionReady;
+    std::queue<Request> requests;
+    std::queue<std::pair<uint64_t, int64_t>> completions;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    ThreadIO() {
+        for (uint32_t i = 0; i < 2; ++i) {
+            workers.emplace_back([this]() { run(); });
+        }
+    }
+    ~ThreadIO() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        requestReady.notify_all();
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+    }
+    void run() {
+        while (1) {
+            Request req;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                requestReady.wait(guard, [&]() { return stopping || !requests.empty(); });
+                if (requests.empty()) {
+                    return;
+                }
+                req = requests.front();
+                requests.pop();
+            }
+            ssize_t n;
+            do {
+                n = req.isWrite ? pwrite(req.fd, req.buf, req.len, static_cast<off_t>(req.off)) : pread(req.fd, req.buf, req.len, static_cast<off_t>(req.off));
+            } while (n < 0 && errno == EINTR);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                completions.push(std::make_pair(req.tag, n < 0 ? -static_cast<int64_t>(errno) : static_cast<int64_t>(n)));
+            }
+            completionReady.notify_one();
+        }
+    }
+    bool submit(bool isWrite, int fd, char* buf, uint32_t len, uint64_t off, uint64_t tag) override {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            requests.push({ isWrite, fd, buf, len, off, tag });
+        }
+        requestReady.notify_one();
+        return true;
+    }
+    bool wait(uint64_t& tag, int64_t& result) override {
+        std::unique_lock<std::mutex> guard(lock);
+        completionReady.wait(guard, [&]() { return !completions.empty(); });
+        tag = completions.front().first;
+        result = completions.front().second;
+        completions.pop();
+        return true;
+    }
+};
+
+#ifdef ROXY_HAVE_IO_URING
+// UringIO
+// io_uring backend driven through the raw syscalls, so no liburing is needed. Uses READV/WRITEV, which every
+// io_uring capable kernel supports, with one iovec per request kept alive until its completion is reaped.
+struct UringIO : AsyncIO {
+    int ringFd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqRingLen = 0, cqRingLen = 0, sqesLen = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    std::map<uint64_t, iovec> iovecs;
+
+    bool init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) {
+            return false;
+        }
+        sqRingLen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingLen = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            sqRingLen = cqRingLen = std::max(sqRingLen, cqRingLen);
+        }
+        sqRing = mmap(nullptr, sqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        cqRing = single ? sqRing : mmap(nullptr, cqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            return false;
+        }
+        sqesLen = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+    ~UringIO() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesLen);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) {
+            munmap(cqRing, cqRingLen);
+        }
+        if (sqRing != MAP_FAILED) {
+            munmap(sqRing, sqRingLen);
+        }
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+    }
+    bool submit(bool isWrite, int fd, char* buf, uint32_t len, uint64_t off, uint64_t tag) override {
+        iovec& vec = iovecs[tag];
+        vec.iov_base = buf;
+        vec.iov_len = len;
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = isWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&vec);
+        sqe->len = 1;
+        sqe->off = off;
+        sqe->user_data = tag;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        long submitted;
+        do {
+            submitted = syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && errno == EINTR);
+        if (submitted != 1) {
+            iovecs.erase(tag);
+            return false;
+        }
+        return true;
+    }
+    bool wait(uint64_t& tag, int64_t& result) override {
+        while (1) {
+            unsigned head = *cqHead;
+            if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                io_uring_cqe* cqe = &cqes[head & *cqMask];
+                tag = cqe->user_data;
+                result = cqe->res;
+                __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+                iovecs.erase(tag);
+                return true;
+            }
+            if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+};
+#endif
+
+// makeAsyncIO(uint32_t entries)
+// PRE: maximum number of requests that will be in flight at once passed
+// POST: io_uring backend returned where the kernel supports it and --io-threads was not given, else the thread backend
+// WARNINGS: None
+// STATUS: Completed, tested
+std::unique_ptr<AsyncIO> makeAsyncIO(uint32_t entries) {
+#ifdef ROXY_HAVE_IO_URING
+    if (!forceThreadIO) {
+        std::unique_ptr<UringIO> uring(new UringIO());
+        if (uring->init(entries)) {
+            return std::unique_ptr<AsyncIO>(uring.release());
+        }
+    }
+#else
+    (void)entries;
+#endif
+    return std::unique_ptr<AsyncIO>(new ThreadIO());
+}
+
+// runPipeline(...)
+// PRE: input as a file path (inData null) or in-memory buffer (inData set), bytes of input to skip, output path
+//      (empty to discard output), bytes to write ahead of the first chunk, chunk length, and a transform passed.
+//      The transform receives each chunk and its offset within the input, in order, and returns the bytes to write.
+// POST: all input transformed and written; false returned on any open, read or write failure
+// WARNINGS: Chunks end at the end of input, so only the last may be shorter than chunkLen. The input size is taken
+//           up front and reads are positional, so input paths that are not regular files (FIFOs, pipes, devices,
+//           directories) are refused rather than read as empty. When the output is the input file itself, the
+//           output is written to a temporary file beside it and renamed over the input only once all of it is written.
+// STATUS: Completed, tested
+bool runPipeline(const std::string& inPath, const std::string* inData, uint64_t inSkip, const std::string& outPath,
+                 const std::string& outPrefix, uint32_t chunkLen, const PipelineTransform& transform) {
+    struct Op {
+        bool isWrite;
+        int slot;
+        uint64_t seq;
+        uint32_t len;
+        uint64_t off;
+        uint32_t done;
+    };
+    struct Ready {
+        int slot;
+        uint64_t off;
+        uint32_t len;
+    };
+    int inFd = -1, outFd = -1;
+    uint64_t inSize;
+    struct stat st;
+    if (inData == nullptr) {
+        inFd = open(inPath.c_str(), O_RDONLY);
+        if (inFd < 0 || fstat(inFd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            if (inFd >= 0) {
+                close(inFd);
+            }
+            return false;
+        }
+        inSize = static_cast<uint64_t>(st.st_size);
+    }
+    else {
+        inSize = inData->length();
+    }
+    std::string tempPath;
+    if (!outPath.empty()) {
+        struct stat outSt;
+        if (inFd >= 0 && stat(outPath.c_str(), &outSt) == 0 && outSt.st_dev == st.st_dev && outSt.st_ino == st.st_ino) {
+            // truncating the output would destroy the input still being read
+            tempPath = outPath + ".XXXXXX";
+            outFd = mkstemp(&tempPath[0]);
+            if (outFd >= 0) {
+                fchmod(outFd, st.st_mode & 0777);
+            }
+        }
+        else {
+            outFd = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        if (outFd < 0) {
+            if (inFd >= 0) {
+                close(inFd);
+            }
+            return false;
+        }
+    }
+    inSkip = std::min(inSkip, inSize);
+    uint64_t totalChunks = (inSize - inSkip + chunkLen - 1) / chunkLen;
+    std::unique_ptr<AsyncIO> io = makeAsyncIO(pipelineDepth * 2 + 1);
+    std::vector<char*> slots;
+    std::vector<int> freeSlots;
+    for (uint32_t i = 0; i < pipelineDepth && inData == nullptr; ++i) {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, pipelineAlign, chunkLen) != 0) {
+            break;
+        }
+        slots.push_back(static_cast<char*>(mem));
+        freeSlots.push_back(static_cast<int>(i));
+    }
+    std::map<uint64_t, Op> pending;
+    std::map<uint64_t, Ready> ready;
+    std::map<uint64_t, std::string> outBufs;
+    uint64_t nextTag = 0, nextReadSeq = 0, nextProcessSeq = 0, readOff = inSkip, outOff = 0;
+    uint32_t readsAhead = 0, writesInFlight = 0;
+    bool ok = inData != nullptr || !slots.empty();
+    auto submitWrite = [&](std::string data) {
+        if (outFd < 0 || data.empty()) {
+            return true;
+        }
+        uint64_t tag = nextTag++;
+        outBufs[tag] = std::move(data);
+        pending[tag] = { true, -1, 0, static_cast<uint32_t>(outBufs[tag].length()), outOff, 0 };
+        outOff += outBufs[tag].length();
+        if (!io->submit(true, outFd, &outBufs[tag][0], pending[tag].len, pending[tag].off, tag)) {
+            pending.erase(tag);
+            outBufs.erase(tag);
+            return false;
+        }
+        ++writesInFlight;
+        return true;
+    };
+    if (ok) {
+        ok = submitWrite(outPrefix);
+    }
+    while (ok && (nextProcessSeq < totalChunks || writesInFlight > 0)) {
+        // keep pipelineDepth chunks read ahead of the transform
+        while (ok && readsAhead < pipelineDepth && nextReadSeq < totalChunks && (inData != nullptr || !freeSlots.empty())) {
+            uint32_t len = static_cast<uint32_t>(std::min<uint64_t>(chunkLen, inSize - readOff));
+            if (inData != nullptr) {
+                ready[nextReadSeq] = { -1, readOff, len };
+            }
+            else {
+                int slot = freeSlots.back();
+                freeSlots.pop_back();
+                uint64_t tag = nextTag++;
+                pending[tag] = { false, slot, nextReadSeq, len, readOff, 0 };
+                ok = io->submit(false, inFd, slots[slot], len, readOff, tag);
+                if (!ok) {
+                    pending.erase(tag);
+                    break;
+                }
+            }
+            ++readsAhead;
+            ++nextReadSeq;
+            readOff += len;
+        }
+        auto it = ready.find(nextProcessSeq);
+        if (ok && it != ready.end() && writesInFlight < pipelineDepth) {
+            Ready chunk = it->second;
+            ready.erase(it);
+            std::string data = inData != nullptr ? inData->substr(chunk.off, chunk.len) : std::string(slots[chunk.slot], chunk.len);
+            if (chunk.slot >= 0) {
+                freeSlots.push_back(chunk.slot);
+            }
+            --readsAhead;
+            ++nextProcessSeq;
+            ok = submitWrite(transform(data, chunk.off - inSkip));
+            STATS_PIPELINE_PROGRESS(nextProcessSeq < totalChunks, chunk.off + chunk.len - inSkip, inSize - inSkip);
+            continue;
+        }
+        if (!ok || pending.empty()) {
+            ok = ok && nextProcessSeq >= totalChunks && writesInFlight == 0;
+            break;
+        }
+        uint64_t tag;
+        int64_t result;
+        {
+            STATS_PHASE(PHASE_IOWAIT);
+            ok = io->wait(tag, result);
+        }
+        if (!ok || pending.count(tag) == 0) {
+            ok = false;
+            break;
+        }
+        Op& op = pending[tag];
+        if (result > 0) {
+            op.done += static_cast<uint32_t>(result);
+        }
+        if (result > 0 && op.done < op.len) {
+            // short transfer: resubmit the remainder under the same tag
+            char* base = op.isWrite ? &outBufs[tag][0] : slots[op.slot];
+            ok = io->submit(op.isWrite, op.isWrite ? outFd : inFd, base + op.done, op.len - op.done, op.off + op.done, tag);
+        }
+        if (result <= 0 || !ok) {
+            // failed, or hit an unexpected end of input: this request is no longer in flight
+            pending.erase(tag);
+            ok = false;
+            break;
+        }
+        if (op.done < op.len) {
+            continue;
+        }
+        if (op.isWrite) {
+            STATS_BYTES(PHASE_WRITE, op.len);
+            outBufs.erase(tag);
+            --writesInFlight;
+        }
+        else {
+            STATS_BYTES(PHASE_READ, op.len);
+            ready[op.seq] = { op.slot, op.off, op.len };
+        }
+        pending.erase(tag);
+    }
+    // drain anything still in flight before its buffers go away
+    while (!pending.empty()) {
+        uint64_t tag;
+        int64_t result;
+        if (!io->wait(tag, result)) {
+            break;
+        }
+        pending.erase(tag);
+    }
+    STATS_PIPELINE_PROGRESS(false, 0, 0);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        free(slots[i]);
+    }
+    if (inFd >= 0) {
+        close(inFd);
+    }
+    if (outFd >= 0 && close(outFd) < 0) {
+        ok = false;
+    }
+    if (!tempPath.empty()) {
+        if (ok && rename(tempPath.c_str(), outPath.c_str()) < 0) {
+            ok = false;
+        }
+        if (!ok) {
+            unlink(tempPath.c_str());
+        }
+    }
+    return ok;
+}
+#else
+// runPipeline(...)
+// PRE: as above
+// POST: as above, reading, transforming and writing one chunk at a time
+// WARNINGS: No overlap between I/O and the transform on this platform. Writing over the input is only detected
+//           when both paths are spelled the same.
+// STATUS: Completed, tested
+bool runPipeline(const std::string& inPath, const std::string* inData, uint64_t inSkip, const std::string& outPath,
+                 const std::string& outPrefix, uint32_t chunkLen, const PipelineTransform& transform) {
+    std::ifstream rawIn;
+    if (inData == nullptr) {
+        rawIn.open(inPath.c_str(), std::ios::binary);
+        if (!rawIn.good()) {
+            return false;
+        }
+        rawIn.seekg(static_cast<std::streamoff>(inSkip));
+    }
+    // truncating the output would destroy the input still being read, so that case goes through a temporary file
+    std::string writePath = inData == nullptr && outPath == inPath ? outPath + ".tmp" : outPath;
+    std::ofstream rawOut;
+    if (!outPath.empty()) {
+        rawOut.open(writePath.c_str(), std::ios::binary);
+        rawOut << outPrefix;
+    }
+    std::string chunk(chunkLen, '\0');
+    for (uint64_t off = 0;; off += chunk.length()) {
+        if (inData != nullptr) {
+            if (inSkip + off >= inData->length()) {
+                break;
+            }
+            chunk = inData->substr(inSkip + off, chunkLen);
+        }
+        else {
+            chunk.resize(chunkLen);
+            rawIn.read(&chunk[0], chunkLen);
+            chunk.resize(static_cast<size_t>(rawIn.gcount()));
+            if (chunk.empty()) {
+                break;
+            }
+        }
+        STATS_BYTES(PHASE_READ, chunk.length());
+        std::string out = transform(chunk, off);
+        STATS_BYTES(PHASE_WRITE, out.length());
+        if (!outPath.empty()) {
+            rawOut << out;
+        }
+    }
+    bool ok = outPath.empty() || rawOut.good();
+    if (writePath != outPath) {
+        rawIn.close();
+        rawOut.close();
+        ok = ok && !rawOut.fail() && std::remove(outPath.c_str()) == 0 && std::rename(writePath.c_str(), outPath.c_str()) == 0;
+        if (!ok) {
+            std::remove(writePath.c_str());
+        }
+    }
+    return ok;
+}
+#endif
+
+// readFileAsync(std::string path, std::string& out)
+// PRE: path to read passed
+// POST: whole file read into out through the pipeline; false returned if it cannot be read
+// WARNINGS: None
+// STATUS: Completed, tested
+bool readFileAsync(std::string path, std::string& out) {
+    STATS_PHASE(PHASE_READ);
+    out.clear();
+    return runPipeline(path, nullptr, 0, "", "", pipelineIOChunk, [&](const std::string& chunk, uint64_t) {
+        out += chunk;
+        return std::string();
+    });
+}
+
+// writeFileAsync(std::string path, const std::string& data)
+// PRE: path and data passed
+// POST: data written to path through the pipeline; false returned on failure
+// WARNINGS: Any existing file at path is replaced
+// STATUS: Completed, tested
+bool writeFileAsync(std::string path, const std::string& data) {
+    STATS_PHASE(PHASE_WRITE);
+    return runPipeline("", &data, 0, path, "", pipelineIOChunk, [](const std::string& chunk, uint64_t) {
+        return chunk;
+    });
+}
+
+// Recipient keys
+// keygen() writes NAME.pub holding n and NAME.key holding p and q, each as decimal text on one line. p and q are
+// 16 bit primes so that n and every element's x0 still fit in 32 bits; like the built-in pair, they are toy-sized.
+
+// readPublicKey(std::string path, Recipient& rcpt)
+// PRE: path to a .pub file passed
+// POST: modulus loaded into rcpt, named after the file without its directory or extension; false if unreadable
+// WARNINGS: The modulus cannot be checked without the private key
+// STATUS: Completed, tested
+bool readPublicKey(std::string path, Recipient& rcpt) {
+    std::ifstream in(path.c_str());
+    unsigned long long n = 0;
+    if (!(in >> n) || n < 4 || n > UINT32_MAX) {
+        return false;
+    }
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    rcpt.name = dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+    rcpt.n = static_cast<uint32_t>(n);
+    return true;
+}
+
+// readPrivateKey(std::string path, Trapdoor& td)
+// PRE: path to a .key file passed
+// POST: trapdoor derived from the file's p and q; false if unreadable or if 17 is not invertible for that pair
+// WARNINGS: None
+// STATUS: Completed, tested
+bool readPrivateKey(std::string path, Trapdoor& td) {
+    std::ifstream in(path.c_str());
+    unsigned long long p = 0, q = 0;
+    if (!(in >> p >> q) || p < 3 || q < 3 || p * q > UINT32_MAX || !isPrime(static_cast<uint32_t>(p)) || !isPrime(static_cast<uint32_t>(q))) {
+        return false;
+    }
+    td = makeTrapdoor(static_cast<uint32_t>(p), static_cast<uint32_t>(q));
+    return (17ULL * td.d) % ((p - 1) * (q - 1)) == 1;
+}
+
+// keygen(int argc, char* argv[])
+// PRE: Program started as: roxy --keygen NAME
+// POST: NAME.pub and NAME.key written for a fresh pair of primes p != q with 17 invertible mod (p - 1)(q - 1);
+//       returns 0 on success
+// WARNINGS: NAME.key must be kept private; anyone holding it can decrypt ciphertexts for NAME.pub
+// STATUS: Completed, tested
+int keygen(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " --keygen NAME" << std::endl;
+        return 1;
+    }
+    std::string name = argv[2];
+    std::random_device rd;
+    std::uniform_int_distribution<uint32_t> dist(1u << 15, (1u << 16) - 1);
+    Trapdoor td;
+    while (1) {
+        uint32_t p = dist(rd), q = dist(rd);
+        if (p == q || !isPrime(p) || !isPrime(q)) {
+            continue;
+        }
+        td = makeTrapdoor(p, q);
+        uint64_t phi = static_cast<uint64_t>(p - 1) * (q - 1);
+        if ((17ULL * td.d) % phi == 1) {
+            break;
+        }
+    }
+    std::ofstream pubOut((name + ".pub").c_str());
+    pubOut << td.n << "\n";
+    pubOut.close();
+    std::ofstream keyOut((name + ".key").c_str());
+    keyOut << td.p << " " << td.q << "\n";
+    keyOut.close();
+    if (!pubOut || !keyOut) {
+        std::cout << "Error: Unable to write " << name << ".pub or " << name << ".key." << std::endl;
+        return 1;
+    }
+    std::cout << "Public key written to: " << name << ".pub" << std::endl;
+    std::cout << "Private key written to: " << name << ".key" << std::endl;
+    return 0;
+}